@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -237,14 +238,39 @@ bool qfind_is_new_connection(int *storage, size_t object_num, int p, int q) {
     return true;
 }
 
+/**
+ * @brief 返回p所在集合的标识，不修改存储数组。
+ */
+int qfind_find(const int *storage, int p) {
+    return storage[p];
+}
+
+/**
+ * @brief 判断p与q是否已连接，不进行联合操作。
+ */
+bool qfind_connected(const int *storage, int p, int q) {
+    return storage[p] == storage[q];
+}
+
 static void qfind_find_operation(int *storage, int p, int q, int *psetval, int *qsetval) {
+    CONNECTIVITY_STATS_FIND_BEGIN();
     *psetval = storage[p];
+    CONNECTIVITY_STATS_FIND_END();
     *qsetval = storage[q];
+    CONNECTIVITY_STATS_FIND_END();
     return;
 }
 
 static void qfind_union_operation(int *storage, size_t object_num, int psetval, int qsetval) {
-    for (int i = 0; i < object_num; i++) if (storage[i] == psetval) storage[i] = qsetval;
+    size_t relabeled_num = 0;
+    for (int i = 0; i < object_num; i++) {
+        if (storage[i] == psetval) {
+            storage[i] = qsetval;
+            relabeled_num++;
+        }
+    }
+    // 被改写的对象个数就是p所在集合的大小
+    CONNECTIVITY_STATS_UNION(relabeled_num);
     return;
 }
 
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "connectivity.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup MmapStorage
+ * @brief 连接问题存储10: 映射到文件的持久化存储。
+ *
+ * ###改进#
+ *
+ * *_new_storage总是在内存中新建存储结构，程序退出后所有连接信息都会丢失，
+ * 重新启动时只能把之前的所有输入对重新处理一遍。
+ *
+ * 本存储把storage_with_tree_size的data和tree_size数组放在一个通过mmap映射到内存的文件中，
+ * 对数组的修改会由操作系统写回文件，再次打开同一个文件时，
+ * 只需重新映射，不需要读取或初始化任何数据，
+ * 需要访问的页面由操作系统的页缓存按需载入。
+ *
+ * ###文件格式#
+ *
+ * | 偏移 | 内容 |
+ * | :--- | :--- |
+ * | 0 | 文件头(struct mmap_storage_header，64字节) |
+ * | 64 | data数组，object_num个int |
+ * | tree_size_offset | tree_size数组，object_num个int，起始位置按64字节对齐 |
+ *
+ * 文件头记录了存储使用的算法、对象的个数和连通分量的个数，
+ * 打开已有文件时前两项必须与调用者给出的参数一致，否则拒绝打开。
+ * 不同算法对数组内容的要求是兼容的，
+ * 但路径压缩过的存储被不压缩的算法继续使用时，性能特征会悄然改变，因此也一并拒绝。
+ *
+ * 新建文件时，文件头的标识最后写入，
+ * 因此初始化过程中被中断的文件会因为标识不符而被拒绝，不会被当作有效的存储使用。
+ *
+ * 数组的页面由操作系统独立地写回文件，文件头中连通分量的个数却只在同步和关闭时更新。
+ * 因此文件头还有一个dirty标志: 打开时置位并立即落盘，同步和关闭时清除。
+ * 打开dirty标志仍然置位的文件(上次使用的进程没有同步就退出了)时，
+ * 不信任文件头中的个数，而是重新统计根节点的个数。
+ * 第1版格式的文件没有这两项(对应的字节为0)，打开时同样重新统计，并升级为当前版本。
+ *
+ * ###使用方法#
+ *
+ * mmap_storage_open返回的结构体中的storage成员就是普通的storage_with_tree_size，
+ * 可以直接传给对应算法的*_is_new_connection函数，例如:
+ * @code
+ * struct mmap_storage *ms = mmap_storage_open("uf.bin", MMAP_STORAGE_W_QUNION_PC_H, 1000000000);
+ * w_qunion_pc_h_is_new_connection(&ms->storage, p, q);
+ * mmap_storage_sync(ms);
+ * mmap_storage_close(ms);
+ * @endcode
+ *
+ * 不能对它调用*_delete_storage，必须使用mmap_storage_close。
+ * 连通分量的个数和大小照常可用，但文件中没有next环，w_qunion_component_members对它返回-1。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+/**
+ * @brief 存储文件的文件头。
+ */
+struct mmap_storage_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t engine;
+    uint64_t object_num;
+    uint64_t data_offset;
+    uint64_t tree_size_offset;
+    // 只在dirty为0时有效
+    uint64_t component_num;
+    // 打开后、同步或关闭前为1
+    uint32_t dirty;
+    unsigned char reserved[12];
+};
+
+static const char g_mmap_storage_magic[8] = "CONNUF\0";
+static const uint32_t g_mmap_storage_version = 2;
+// 仍可打开的最早版本: 第1版没有component_num和dirty
+static const uint32_t g_mmap_storage_min_version = 1;
+
+static uint64_t mmap_storage_align(uint64_t offset) {
+    return (offset + 63) & ~(uint64_t)63;
+}
+
+static struct mmap_storage *mmap_storage_map(int fd, size_t length) {
+    void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    struct mmap_storage *storage = malloc(sizeof(*storage));
+    if (storage == NULL) {
+        munmap(base, length);
+        return NULL;
+    }
+    storage->base = base;
+    storage->length = length;
+    storage->fd = fd;
+    return storage;
+}
+
+static void mmap_storage_attach(struct mmap_storage *storage) {
+    struct mmap_storage_header *header = storage->base;
+    storage->storage.data = (int *)((char *)storage->base + header->data_offset);
+    storage->storage.tree_size = (int *)((char *)storage->base + header->tree_size_offset);
+    // next环不保存在文件中，因此不能列出连通分量的对象
+    storage->storage.next = NULL;
+    storage->storage.component_num = header->component_num;
+    if (header->version < g_mmap_storage_version || header->dirty) {
+        storage->storage.component_num = 0;
+        for (size_t i = 0; i < header->object_num; i++) {
+            if (storage->storage.data[i] == i) storage->storage.component_num++;
+        }
+    }
+    return;
+}
+
+/**
+ * @brief 置位dirty标志并等待文件头落盘，此后数组的修改才可以写回文件。
+ */
+static bool mmap_storage_mark_dirty(struct mmap_storage *storage) {
+    struct mmap_storage_header *header = storage->base;
+    header->version = g_mmap_storage_version;
+    header->dirty = 1;
+    return msync(storage->base, sizeof(*header), MS_SYNC) == 0;
+}
+
+static void mmap_storage_mark_clean(struct mmap_storage *storage) {
+    struct mmap_storage_header *header = storage->base;
+    header->component_num = storage->storage.component_num;
+    header->dirty = 0;
+    return;
+}
+
+static void mmap_storage_unmap(struct mmap_storage *storage) {
+    munmap(storage->base, storage->length);
+    free(storage);
+    return;
+}
+
+static struct mmap_storage *mmap_storage_create(int fd, enum mmap_storage_engine engine, size_t object_num) {
+    uint64_t data_offset = sizeof(struct mmap_storage_header);
+    uint64_t tree_size_offset = mmap_storage_align(data_offset + sizeof(int) * object_num);
+    uint64_t length = tree_size_offset + sizeof(int) * object_num;
+
+    if (ftruncate(fd, length) != 0) return NULL;
+
+    struct mmap_storage *storage = mmap_storage_map(fd, length);
+    if (storage == NULL) return NULL;
+
+    struct mmap_storage_header *header = storage->base;
+    header->version = g_mmap_storage_version;
+    header->engine = engine;
+    header->object_num = object_num;
+    header->data_offset = data_offset;
+    header->tree_size_offset = tree_size_offset;
+    header->component_num = object_num;
+    mmap_storage_attach(storage);
+    // attach之后才置位，使attach直接使用component_num，而不是统计尚未初始化的数组
+    header->dirty = 1;
+
+    for (size_t i = 0; i < object_num; i++) {
+        storage->storage.data[i] = i;
+        storage->storage.tree_size[i] = 1;
+    }
+
+    // 数组全部落盘后才写入标识
+    if (msync(storage->base, length, MS_SYNC) != 0) {
+        mmap_storage_unmap(storage);
+        return NULL;
+    }
+    memcpy(header->magic, g_mmap_storage_magic, sizeof(header->magic));
+
+    return storage;
+}
+
+static bool mmap_storage_header_matches(const struct mmap_storage_header *header, enum mmap_storage_engine engine,
+                                        size_t object_num, size_t file_length) {
+    if (memcmp(header->magic, g_mmap_storage_magic, sizeof(header->magic)) != 0) return false;
+    if (header->version < g_mmap_storage_min_version || header->version > g_mmap_storage_version) return false;
+    if (header->engine != engine || header->object_num != object_num) return false;
+    if (header->data_offset + sizeof(int) * object_num > file_length) return false;
+    if (header->tree_size_offset + sizeof(int) * object_num > file_length) return false;
+    return true;
+}
+
+/**
+ * @brief 打开或新建path处的存储文件。
+ *
+ * 文件不存在或为空时新建并初始化存储，
+ * 文件已存在时，文件头记录的算法和对象个数必须与engine和object_num一致，否则返回NULL。
+ */
+struct mmap_storage *mmap_storage_open(const char *path, enum mmap_storage_engine engine, size_t object_num) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct mmap_storage *storage = NULL;
+    if (file_stat.st_size == 0) {
+        storage = mmap_storage_create(fd, engine, object_num);
+    } else if ((size_t)file_stat.st_size >= sizeof(struct mmap_storage_header)) {
+        struct mmap_storage_header header;
+        if (pread(fd, &header, sizeof(header), 0) == sizeof(header)
+            && mmap_storage_header_matches(&header, engine, object_num, file_stat.st_size)) {
+            storage = mmap_storage_map(fd, file_stat.st_size);
+            if (storage != NULL) {
+                mmap_storage_attach(storage);
+                if (!mmap_storage_mark_dirty(storage)) {
+                    mmap_storage_unmap(storage);
+                    storage = NULL;
+                }
+            }
+        }
+    }
+
+    if (storage == NULL) close(fd);
+    return storage;
+}
+
+/**
+ * @brief 将修改写回文件，成功时返回true。
+ *
+ * 返回后文件头中连通分量的个数与数组一致，之后的修改开始前dirty标志已重新落盘。
+ */
+bool mmap_storage_sync(struct mmap_storage *storage) {
+    mmap_storage_mark_clean(storage);
+    bool synced = msync(storage->base, storage->length, MS_SYNC) == 0;
+    return mmap_storage_mark_dirty(storage) && synced;
+}
+
+/**
+ * @brief 解除映射并关闭文件。
+ *
+ * 关闭时不等待修改写回文件，需要确保修改已经落盘时，先调用mmap_storage_sync。
+ */
+void mmap_storage_close(struct mmap_storage *storage) {
+    if (storage != NULL) {
+        mmap_storage_mark_clean(storage);
+        close(storage->fd);
+        mmap_storage_unmap(storage);
+    }
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- MmapStorage
+ ****************************************/
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include "connectivity.h"
+#include "uf-engine.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup KeyedQuickUnion
+ * @brief 连接问题算法11: Keyed-quick-union算法。
+ *
+ * ###改进#
+ *
+ * 前面的算法都要求对象是0到object_num-1之间的连续整数。
+ * 实际应用中的对象往往是分散在整个64位范围内的标识(例如哈希过的实体ID)，
+ * 既不能直接作为数组下标，总数也无法事先知道。
+ *
+ * 本算法在通用引擎之前加一层从64位键到连续序号的映射:
+ * 每个键第一次出现时分配下一个序号，之后总是映射到同一个序号，
+ * 连接关系则交给通用引擎的uf_w_qunion_pc_h_z处理，
+ * 即零初始化排列的Weighted-quick-union-with-path-compression-by-halving算法。
+ *
+ * ###数据结构#
+ *
+ * 映射是一个开放寻址的哈希表，采用Robin Hood探测:
+ * - 每个槽位占16个字节，存放键、序号和该键距离其理想位置的探测距离，
+ *   一条cache line可以装下4个槽位，探测只需顺序访问相邻的槽位。
+ * - 插入时，如果当前槽位中的键的探测距离比待插入的键短，就让待插入的键占据该槽位，
+ *   被替换的键继续向后寻找位置。这样所有键的探测距离都比较平均，
+ *   装载因子达到7/8时平均探测长度仍然很短。
+ * - 查找时，一旦遇到探测距离比当前距离短的槽位，就可以断定键不存在，不必探测到空槽位。
+ *
+ * 键的个数超过容量的7/8时，哈希表的容量翻倍；
+ * 键的个数达到引擎存储的对象数时，通过uf_grow_storage把引擎的存储扩大一倍，
+ * 零初始化排列的扩容只需把新增部分清零。
+ * 因此存储随着键的出现按需增长，创建时给出的键的个数只是预估值。
+ *
+ * ###批量处理#
+ *
+ * 键分散在整个哈希表中，每次查找几乎都要从内存读取一条cache line。
+ * k_qunion_index_batch和k_qunion_process_batch每次处理KEYED_QUNION_BATCH_WIDTH个键:
+ * 先计算这一组键的哈希值并预取它们的理想槽位，再逐个探测，
+ * 这样一组键的内存访问是重叠进行的。
+ * k_qunion_process_batch在得到一组输入对的序号后，
+ * 再预取它们在引擎存储中的元素，然后才逐个处理。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+/**
+ * @brief 批量处理时每组键(或输入对)的个数。
+ */
+#define KEYED_QUNION_BATCH_WIDTH 16
+
+/**
+ * @brief 键的个数与哈希表容量之比的上限为KEYED_QUNION_MAX_LOAD/8。
+ */
+#define KEYED_QUNION_MAX_LOAD 7
+
+#define KEYED_QUNION_MIN_CAPACITY 16
+
+/**
+ * @brief 键的哈希函数，使用SplitMix64的最终混合函数。
+ */
+static inline uint64_t k_qunion_hash(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+static struct keyed_slot *k_qunion_new_slots(size_t capacity) {
+    // distance为0表示空槽位
+    return calloc(capacity, sizeof(struct keyed_slot));
+}
+
+/**
+ * @brief 将一个不在哈希表中的键放入哈希表，slot的distance必须为1。
+ */
+static void k_qunion_place(struct keyed_slot *slots, size_t slot_mask, uint64_t hash, struct keyed_slot slot) {
+    size_t pos = hash & slot_mask;
+    while (slots[pos].distance != 0) {
+        if (slots[pos].distance < slot.distance) {
+            struct keyed_slot tmp = slots[pos];
+            slots[pos] = slot;
+            slot = tmp;
+        }
+        pos = (pos + 1) & slot_mask;
+        slot.distance++;
+    }
+    slots[pos] = slot;
+    return;
+}
+
+static bool k_qunion_grow_slots(struct keyed_storage *storage) {
+    size_t capacity = (storage->slot_mask + 1) * 2;
+    struct keyed_slot *slots = k_qunion_new_slots(capacity);
+    if (slots == NULL) return false;
+
+    for (size_t i = 0; i <= storage->slot_mask; i++) {
+        struct keyed_slot slot = storage->slots[i];
+        if (slot.distance == 0) continue;
+        slot.distance = 1;
+        k_qunion_place(slots, capacity - 1, k_qunion_hash(slot.key), slot);
+    }
+    free(storage->slots);
+    storage->slots = slots;
+    storage->slot_mask = capacity - 1;
+    return true;
+}
+
+/**
+ * @brief 查找键的序号，键不存在时返回-1，hash必须是k_qunion_hash(key)。
+ */
+static int k_qunion_probe(const struct keyed_storage *storage, uint64_t key, uint64_t hash) {
+    const struct keyed_slot *slots = storage->slots;
+    size_t pos = hash & storage->slot_mask;
+    uint32_t distance = 1;
+
+    for (; slots[pos].distance >= distance; pos = (pos + 1) & storage->slot_mask, distance++) {
+        if (slots[pos].key == key) return slots[pos].index;
+    }
+    return -1;
+}
+
+/**
+ * @brief 查找键的序号，键不存在时为其分配新的序号，hash必须是k_qunion_hash(key)。
+ */
+static int k_qunion_lookup(struct keyed_storage *storage, uint64_t key, uint64_t hash) {
+    int index = k_qunion_probe(storage, key, hash);
+    if (index >= 0) return index;
+
+    // 键不存在，分配下一个序号
+    if (storage->key_num == INT_MAX) return -1;
+    if ((storage->key_num + 1) * 8 > (storage->slot_mask + 1) * KEYED_QUNION_MAX_LOAD
+        && !k_qunion_grow_slots(storage)) return -1;
+    if (storage->key_num == storage->uf->object_num
+        && !uf_grow_storage(storage->uf, storage->uf->object_num * 2)) return -1;
+
+    struct keyed_slot slot = {key, storage->key_num, 1};
+    k_qunion_place(storage->slots, storage->slot_mask, hash, slot);
+    return storage->key_num++;
+}
+
+/**
+ * @brief 新建存储，expected_key_num是预估的键的个数，实际个数可以超过它。
+ */
+struct keyed_storage *k_qunion_new_storage(size_t expected_key_num) {
+    size_t capacity = KEYED_QUNION_MIN_CAPACITY;
+    while (capacity * KEYED_QUNION_MAX_LOAD / 8 < expected_key_num) capacity *= 2;
+    size_t object_num = expected_key_num < KEYED_QUNION_MIN_CAPACITY ? KEYED_QUNION_MIN_CAPACITY : expected_key_num;
+
+    struct keyed_storage *storage = malloc(sizeof(*storage));
+    if (storage == NULL) return NULL;
+    storage->slots = k_qunion_new_slots(capacity);
+    storage->slot_mask = capacity - 1;
+    storage->key_num = 0;
+    storage->uf = uf_w_qunion_pc_h_z_new_storage(object_num);
+    if (storage->slots == NULL || storage->uf == NULL) {
+        k_qunion_delete_storage(storage);
+        return NULL;
+    }
+    return storage;
+}
+
+void k_qunion_delete_storage(struct keyed_storage *storage) {
+    if (storage != NULL) {
+        free(storage->slots);
+        uf_delete_storage(storage->uf);
+        free(storage);
+    }
+    return;
+}
+
+/**
+ * @brief 返回键对应的连续序号，键第一次出现时为其分配新的序号。
+ *
+ * 内存不足或键的个数超过INT_MAX时返回-1。
+ */
+int k_qunion_index(struct keyed_storage *storage, uint64_t key) {
+    return k_qunion_lookup(storage, key, k_qunion_hash(key));
+}
+
+/**
+ * @brief 批量查找key_num个键的序号，结果依次存入indices。
+ */
+void k_qunion_index_batch(struct keyed_storage *storage, const uint64_t *keys, size_t key_num, int *indices) {
+    uint64_t hashes[KEYED_QUNION_BATCH_WIDTH];
+
+    for (size_t start = 0; start < key_num; start += KEYED_QUNION_BATCH_WIDTH) {
+        size_t width = key_num - start < KEYED_QUNION_BATCH_WIDTH ? key_num - start : KEYED_QUNION_BATCH_WIDTH;
+        for (size_t i = 0; i < width; i++) {
+            hashes[i] = k_qunion_hash(keys[start + i]);
+            __builtin_prefetch(&storage->slots[hashes[i] & storage->slot_mask]);
+        }
+        for (size_t i = 0; i < width; i++) {
+            indices[start + i] = k_qunion_lookup(storage, keys[start + i], hashes[i]);
+        }
+    }
+    return;
+}
+
+/**
+ * @brief 判断两个键是否为新连接。
+ *
+ * 内存不足而无法为新出现的键分配序号时返回false。
+ */
+bool k_qunion_is_new_connection(struct keyed_storage *storage, uint64_t p, uint64_t q) {
+    int pindex = k_qunion_index(storage, p);
+    int qindex = k_qunion_index(storage, q);
+    if (pindex < 0 || qindex < 0) return false;
+    return uf_w_qunion_pc_h_z_is_new_connection(storage->uf, pindex, qindex);
+}
+
+/**
+ * @brief 返回键所在树的根节点的序号，键从未出现过时返回-1。
+ *
+ * 查询不会为新的键分配序号。
+ */
+int k_qunion_find(struct keyed_storage *storage, uint64_t key) {
+    int index = k_qunion_probe(storage, key, k_qunion_hash(key));
+    return index < 0 ? -1 : uf_w_qunion_pc_h_z_find(storage->uf, index);
+}
+
+/**
+ * @brief 判断两个键是否已连接，从未出现过的键只与自身相连。
+ */
+bool k_qunion_connected(struct keyed_storage *storage, uint64_t p, uint64_t q) {
+    if (p == q) return true;
+    int pindex = k_qunion_probe(storage, p, k_qunion_hash(p));
+    int qindex = k_qunion_probe(storage, q, k_qunion_hash(q));
+    if (pindex < 0 || qindex < 0) return false;
+    return uf_w_qunion_pc_h_z_connected(storage->uf, pindex, qindex);
+}
+
+/**
+ * @brief 不压缩路径的k_qunion_connected，只读取存储结构，可以由多个线程同时调用。
+ */
+bool k_qunion_connected_readonly(const struct keyed_storage *storage, uint64_t p, uint64_t q) {
+    if (p == q) return true;
+    int pindex = k_qunion_probe(storage, p, k_qunion_hash(p));
+    int qindex = k_qunion_probe(storage, q, k_qunion_hash(q));
+    if (pindex < 0 || qindex < 0) return false;
+    return uf_w_qunion_pc_h_z_connected_readonly(storage->uf, pindex, qindex);
+}
+
+/**
+ * @brief 批量处理pair_num个输入对，结果以位图的形式输出到out_bitmap。
+ *
+ * 位图的格式与w_qunion_pc_h_process_batch相同。
+ * 内存不足而无法为新出现的键分配序号时，对应的输入对按非新连接处理。
+ */
+void k_qunion_process_batch(struct keyed_storage *storage, uint64_t (*pairs)[2], size_t pair_num, unsigned char *out_bitmap) {
+    uint64_t hashes[KEYED_QUNION_BATCH_WIDTH][2];
+    int indices[KEYED_QUNION_BATCH_WIDTH][2];
+
+    for (size_t start = 0; start < pair_num; start += KEYED_QUNION_BATCH_WIDTH) {
+        size_t width = pair_num - start < KEYED_QUNION_BATCH_WIDTH ? pair_num - start : KEYED_QUNION_BATCH_WIDTH;
+
+        // 第一步: 计算哈希值并预取理想槽位
+        for (size_t i = 0; i < width; i++) {
+            hashes[i][0] = k_qunion_hash(pairs[start + i][0]);
+            hashes[i][1] = k_qunion_hash(pairs[start + i][1]);
+            __builtin_prefetch(&storage->slots[hashes[i][0] & storage->slot_mask]);
+            __builtin_prefetch(&storage->slots[hashes[i][1] & storage->slot_mask]);
+        }
+        // 第二步: 探测哈希表得到序号，并预取引擎存储中的元素
+        for (size_t i = 0; i < width; i++) {
+            indices[i][0] = k_qunion_lookup(storage, pairs[start + i][0], hashes[i][0]);
+            indices[i][1] = k_qunion_lookup(storage, pairs[start + i][1], hashes[i][1]);
+            if (indices[i][0] >= 0) __builtin_prefetch(&storage->uf->data[indices[i][0]], 1);
+            if (indices[i][1] >= 0) __builtin_prefetch(&storage->uf->data[indices[i][1]], 1);
+        }
+        // 第三步: 逐个处理
+        for (size_t i = 0; i < width; i++) {
+            size_t n = start + i;
+            if (n % 8 == 0) out_bitmap[n / 8] = 0;
+            if (indices[i][0] >= 0 && indices[i][1] >= 0
+                && uf_w_qunion_pc_h_z_is_new_connection(storage->uf, indices[i][0], indices[i][1])) {
+                out_bitmap[n / 8] |= 1U << (n % 8);
+            }
+        }
+    }
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- KeyedQuickUnion
+ ****************************************/
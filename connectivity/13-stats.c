@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup ConnectivityStats
+ * @brief 连接问题统计13: 搜索与联合操作的计数。
+ *
+ * ###改进#
+ *
+ * 速度测试只给出总耗时，无法说明两个算法为什么快或慢，
+ * 例如Heighted-quick-union算法与Weighted-quick-union算法的耗时几乎相同，
+ * 只看耗时无法判断是因为两者的树高度相近，还是因为其他开销掩盖了差别。
+ *
+ * 编译时定义CONNECTIVITY_STATS后，各算法的搜索操作和联合操作会记录:
+ * - 每次追溯的路径长度(沿父节点指针移动的次数)，包括总和、最大值和按2的幂分桶的直方图。
+ * - 路径压缩修改父节点的次数。
+ * - 联合的次数，按被连接到下方的树的节点数分类。
+ *   Quick-union、Heighted-quick-union等不记录节点数的算法只计入总数。
+ *
+ * 没有定义CONNECTIVITY_STATS时，connectivity-stats.h中的宏全部展开为空语句，
+ * 本文件也不包含任何代码，因此默认编译的算法与没有插入统计时完全相同。
+ *
+ * 统计数据保存在线程局部变量中，
+ * 多线程使用Concurrent-quick-union算法时，每个线程只能读到自己的统计。
+ *
+ * @{
+ ****************************************/
+
+#if !defined(DOC_COMPILE) && defined(CONNECTIVITY_STATS)
+
+_Thread_local struct connectivity_stats g_connectivity_stats;
+
+void connectivity_stats_reset(void) {
+    memset(&g_connectivity_stats, 0, sizeof(g_connectivity_stats));
+    return;
+}
+
+static void connectivity_stats_print_classes(FILE *stream, const char *title, const uint64_t *classes) {
+    fprintf(stream, "  %s:", title);
+    for (int k = 0; k < CONNECTIVITY_STATS_CLASS_NUM; k++) {
+        if (classes[k] == 0) continue;
+        if (k == 0) fprintf(stream, " [0]=%llu", (unsigned long long)classes[k]);
+        else fprintf(stream, " [%llu,%llu)=%llu", 1ULL << (k - 1), 1ULL << k, (unsigned long long)classes[k]);
+    }
+    fprintf(stream, "\n");
+    return;
+}
+
+/**
+ * @brief 输出当前线程的统计数据。
+ */
+void connectivity_stats_print(FILE *stream) {
+    const struct connectivity_stats *stats = &g_connectivity_stats;
+    fprintf(stream, "  finds: %llu, hops: %llu (%.3f per find), max path length: %llu, compression writes: %llu\n",
+            (unsigned long long)stats->find_num, (unsigned long long)stats->hop_num,
+            stats->find_num > 0 ? (double)stats->hop_num / stats->find_num : 0.0,
+            (unsigned long long)stats->max_path_length, (unsigned long long)stats->compression_write_num);
+    connectivity_stats_print_classes(stream, "path length", stats->path_length);
+    fprintf(stream, "  unions: %llu (%llu without size)\n",
+            (unsigned long long)stats->union_num, (unsigned long long)stats->unsized_union_num);
+    connectivity_stats_print_classes(stream, "union size", stats->union_size);
+    return;
+}
+
+#endif // #if !defined(DOC_COMPILE) && defined(CONNECTIVITY_STATS)
+
+/****************************************
+ * @} -- ConnectivityStats
+ ****************************************/
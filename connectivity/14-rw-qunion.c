@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "connectivity.h"
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup ReadMostlyQuickUnion
+ * @brief 连接问题算法14: Read-mostly-weighted-quick-union算法。
+ *
+ * ###改进#
+ *
+ * Concurrent-quick-union算法允许任意多个线程同时联合，代价是每次压缩和联合都要CAS，
+ * 并且只能按随机优先级连接，不能使用节点数。
+ *
+ * 常见的另一种用法是一个线程持续输入新的输入对，其他许多线程只查询两个对象是否已连接。
+ * 这时只有一个线程修改存储数组，修改不需要CAS，
+ * 写线程可以照常使用Weighted-quick-union-with-path-compression-by-halving算法，
+ * 读线程则既不加锁，也不修改存储数组。
+ *
+ * ###数据结构#
+ *
+ * 与Weighted-quick-union-with-path-compression-by-halving算法相同，
+ * 只是父节点数组的元素是原子变量，读线程因此不会读到写了一半的父节点。
+ * 树的节点数只由写线程读写，仍是普通的数组。
+ *
+ * ###算法描述#
+ *
+ * -# 写操作rw_qunion_is_new_connection
+ *
+ *    同一时刻只能有一个线程调用。
+ *    与Weighted-quick-union-with-path-compression-by-halving算法相同，
+ *    只是修改父节点时使用release语义的原子写入，x86上它与普通的写入是同一条指令。
+ *
+ * -# 读操作rw_qunion_find和rw_qunion_connected
+ *
+ *    可以由任意多个线程与写线程同时调用，只使用acquire语义的原子读取。
+ *
+ *    写线程只会把节点的父节点改为它当前的某个祖先(减半压缩改为祖父节点，联合只修改根节点)，
+ *    而祖先关系一旦成立就不会再改变，
+ *    所以读线程无论读到的父节点是新是旧，都是该节点此刻的祖先，
+ *    沿父节点向上的路径不会出现闭环，追溯总能到达根节点。
+ *
+ *    与Concurrent-quick-union算法的connected操作相同，
+ *    两个根节点不同时，需要确认前一个根节点仍是根节点，才能判断两个对象未连接，否则重试。
+ *    根节点一旦被连接到其他树下就不会再成为根节点，
+ *    因此确认成功时，在追溯后一个对象的时刻两个对象确实不在同一个树中。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+static int rw_qunion_find_operation(struct rw_storage *storage, int p);
+static void rw_qunion_union_operation(struct rw_storage *storage, int proot, int qroot);
+
+struct rw_storage *rw_qunion_new_storage(size_t object_num) {
+    _Atomic int *data = malloc(sizeof(*data) * object_num);
+    int *tree_size = malloc(sizeof(*tree_size) * object_num);
+    struct rw_storage *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && storage != NULL) {
+        for (size_t i = 0; i < object_num; i++) {
+            atomic_init(&data[i], i);
+            tree_size[i] = 1;
+        }
+        storage->data = data;
+        storage->tree_size = tree_size;
+        storage->object_num = object_num;
+        return storage;
+    }
+    free(data);
+    free(tree_size);
+    free(storage);
+    return NULL;
+}
+
+void rw_qunion_delete_storage(struct rw_storage *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage->tree_size);
+        free(storage);
+    }
+    return;
+}
+
+/**
+ * @brief 写操作，同一时刻只能有一个线程调用。
+ */
+bool rw_qunion_is_new_connection(struct rw_storage *storage, int p, int q) {
+    int proot = rw_qunion_find_operation(storage, p);
+    int qroot = rw_qunion_find_operation(storage, q);
+    if (proot == qroot) return false;
+    rw_qunion_union_operation(storage, proot, qroot);
+    return true;
+}
+
+/**
+ * @brief 读操作，返回p当前所在树的根节点。
+ *
+ * 写线程同时进行联合时，返回值在返回时可能已经不是根节点。
+ */
+int rw_qunion_find(const struct rw_storage *storage, int p) {
+    int i = p, parent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    while ((parent = atomic_load_explicit(&storage->data[i], memory_order_acquire)) != i) {
+        i = parent;
+        CONNECTIVITY_STATS_HOP();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 读操作，判断两个对象是否已连接。
+ */
+bool rw_qunion_connected(const struct rw_storage *storage, int p, int q) {
+    int proot, qroot;
+    for (;;) {
+        proot = rw_qunion_find(storage, p);
+        qroot = rw_qunion_find(storage, q);
+        if (proot == qroot) return true;
+        if (atomic_load_explicit(&storage->data[proot], memory_order_acquire) == proot) return false;
+    }
+}
+
+static int rw_qunion_find_operation(struct rw_storage *storage, int p) {
+    // 只有写线程修改父节点，因此写线程自己的读取不需要任何同步
+    int i = p, parent, grandparent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    while ((parent = atomic_load_explicit(&storage->data[i], memory_order_relaxed)) != i) {
+        grandparent = atomic_load_explicit(&storage->data[parent], memory_order_relaxed);
+        if (grandparent != parent) {
+            atomic_store_explicit(&storage->data[i], grandparent, memory_order_release);
+            CONNECTIVITY_STATS_COMPRESSION_WRITE();
+        }
+        i = grandparent;
+        CONNECTIVITY_STATS_HOP();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+static void rw_qunion_union_operation(struct rw_storage *storage, int proot, int qroot) {
+    if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[proot]);
+        atomic_store_explicit(&storage->data[proot], qroot, memory_order_release);
+        storage->tree_size[qroot] += storage->tree_size[proot];
+    } else {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
+        atomic_store_explicit(&storage->data[qroot], proot, memory_order_release);
+        storage->tree_size[proot] += storage->tree_size[qroot];
+    }
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- ReadMostlyQuickUnion
+ ****************************************/
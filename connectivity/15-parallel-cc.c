@@ -0,0 +1,496 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "connectivity.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup ParallelConnectedComponents
+ * @brief 连接问题算法15: 离线并行连通分量算法。
+ *
+ * ###改进#
+ *
+ * 前面的算法都是在线的: 每输入一个输入对，就要立即回答它是否为新连接。
+ * 如果所有输入对事先已经全部在内存中，而且只需要最终的连通分量，
+ * 就不必逐个处理输入对，可以让所有核同时处理整个输入对数组。
+ *
+ * 本算法沿用Afforest算法(Sutton等，2018)的思路，
+ * 计算结果为每个对象的标号，两个对象连通当且仅当标号相同，
+ * 标号取连通分量中序号最小的对象。
+ *
+ * ###数据结构#
+ *
+ * 与Quick-union算法相同，只有一个父节点数组，它最终就是标号数组。
+ *
+ * ###算法描述#
+ *
+ * -# 连接
+ *
+ *    与Concurrent-quick-union算法相同，只是优先级就是序号本身:
+ *    追溯根节点时以CAS进行路径减半，然后用CAS把序号较大的根节点连接到序号较小的根节点下，
+ *    因此沿任何路径向上序号严格递减，不会出现闭环，根节点总是树中序号最小的对象。
+ *
+ * -# 指针跳跃(pointer jumping)
+ *
+ *    不进行连接时，所有线程各自负责一段对象，
+ *    沿父节点追溯到根节点，再把对象的父节点直接改为根节点。
+ *    其他线程同时修改的父节点也只会指向原来的某个祖先，因此追溯的结果不受影响。
+ *
+ * -# 采样
+ *
+ *    首先只连接均匀分布在输入对数组中的约object_num个输入对，再进行一次指针跳跃。
+ *    对于随机的输入，此时大多数对象已经在同一个大连通分量中，而且都直接指向根节点，
+ *    剩余的输入对中的大部分只需读取两个父节点、发现它们相同就可以跳过，
+ *    不需要CAS，也不会修改被其他核共享的cache line。
+ *
+ * -# 完成
+ *
+ *    连接剩余的输入对，最后再进行一次指针跳跃，此时每个对象的父节点就是标号。
+ *
+ * 每个阶段都把工作平均分给各线程，阶段之间等待所有线程结束。
+ * 线程创建失败时由当前线程补做该线程的工作，结果不受影响。
+ *
+ * ###新连接标志#
+ *
+ * 标号只说明最终的连通分量，而逐个处理输入对的算法报告的新连接
+ * 是按输入顺序贪心选出的生成森林，它取决于输入对的顺序，上面的算法得不到它。
+ *
+ * p_cc_process_batch用确定性预约(deterministic reservations，Blelloch等，2012)并行地计算这些标志，
+ * 结果与w_qunion_pc_h_process_batch的位图完全相同。
+ * 尚未处理的输入对中最靠前的至多P_CC_WINDOW个组成一个窗口，每一轮分两个阶段:
+ *
+ * -# 预约
+ *
+ *    各线程追溯窗口中每个输入对的两个根节点。
+ *    根节点相同的输入对是旧连接，直接完成。
+ *    否则在两个根节点上预约: 以原子的方式把根节点的预约值改为它与输入对在窗口中的位置二者中的较小值。
+ *
+ * -# 提交
+ *
+ *    持有至少一个根节点的预约(预约值等于自己的位置)的输入对是新连接，
+ *    它把自己持有的根节点连接到另一个根节点下，并清除自己持有的预约。
+ *    持有某个根节点的预约，说明窗口中更靠前的未完成的输入对都不涉及该根节点所在的树，
+ *    在顺序处理时这棵树在它之前不会与其他树合并，因此它确实是新连接。
+ *    其余输入对留到下一轮，窗口中最靠前的未完成输入对每一轮必定完成。
+ *
+ * 一个根节点只有一个持有者，沿着本轮的连接也不会形成闭环
+ * (闭环上的每个输入对都必须比下一个输入对更靠前)，因此提交阶段不需要CAS。
+ *
+ * 预约和提交使每个新连接多读写两次预约值，只用一个线程时得不偿失。
+ * 窗口中的输入对太少、一轮只分给一个线程时，直接按顺序处理整个窗口。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+/**
+ * @brief 采样阶段大约连接object_num * P_CC_SAMPLE_RATIO个输入对。
+ */
+#define P_CC_SAMPLE_RATIO 1
+
+/**
+ * @brief 每个线程至少负责的输入对个数，避免为少量输入对创建线程。
+ */
+#define P_CC_MIN_CHUNK 65536
+
+/**
+ * @brief 预取的距离，与w_qunion_pc_h_process_batch相同。
+ */
+#define P_CC_PREFETCH_DISTANCE 16
+
+/**
+ * @brief p_cc_process_batch每一轮最多处理的输入对个数。
+ */
+#define P_CC_WINDOW (1 << 16)
+
+/**
+ * @brief p_cc_process_batch每个线程在一轮中至少负责的输入对个数。
+ */
+#define P_CC_MIN_WINDOW_CHUNK 4096
+
+/**
+ * @brief 一个线程在一个阶段中负责的区间。
+ */
+struct p_cc_task {
+    int *data;
+    int (*pairs)[2];
+    size_t begin, end;          ///< 区间，对象或输入对的序号
+    size_t stride;              ///< 采样的间隔，只用于连接输入对的阶段
+    bool sampled;               ///< true时只连接采样的输入对，false时只连接其余输入对
+    size_t root_num;            ///< 统计根节点的阶段的结果
+    int *reservation;           ///< 根节点的预约值，只用于p_cc_process_batch
+    size_t *window;             ///< 窗口中输入对的序号
+    int (*roots)[2];            ///< 窗口中输入对的两个根节点，旧连接的第一个根节点为-1
+    size_t survivor_num;        ///< 提交阶段的结果，留到下一轮的输入对个数
+    unsigned char *out_bitmap;
+};
+
+static void p_cc_run_phase(struct p_cc_task *tasks, int thread_num, void *(*phase)(void *));
+
+static void *p_cc_init_phase(void *arg);
+static void *p_cc_link_phase(void *arg);
+static void *p_cc_compress_phase(void *arg);
+static void *p_cc_count_phase(void *arg);
+static void *p_cc_reserve_phase(void *arg);
+static void *p_cc_commit_phase(void *arg);
+static void *p_cc_sequential_phase(void *arg);
+
+/**
+ * @brief 计算输入对数组的连通分量。
+ *
+ * thread_num不大于0时使用所有在线的核，失败时返回NULL。
+ */
+struct cc_labels *p_cc_new_labels(int (*pairs)[2], size_t pair_num, size_t object_num, int thread_num) {
+    if (thread_num <= 0) {
+        long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_num = cpu_num < 1 ? 1 : (int)cpu_num;
+    }
+    if (pair_num / P_CC_MIN_CHUNK < thread_num) thread_num = pair_num / P_CC_MIN_CHUNK + 1;
+
+    struct cc_labels *labels = malloc(sizeof(*labels));
+    int *data = malloc(sizeof(*data) * object_num);
+    struct p_cc_task *tasks = malloc(sizeof(*tasks) * thread_num);
+    if (labels == NULL || data == NULL || tasks == NULL) {
+        free(labels);
+        free(data);
+        free(tasks);
+        return NULL;
+    }
+
+    size_t stride = object_num * P_CC_SAMPLE_RATIO >= pair_num ? 1 : pair_num / (object_num * P_CC_SAMPLE_RATIO);
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].data = data;
+        tasks[t].pairs = pairs;
+        tasks[t].stride = stride;
+        tasks[t].root_num = 0;
+        tasks[t].reservation = NULL;
+    }
+
+    // 按对象划分: 初始化
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].begin = object_num * t / thread_num;
+        tasks[t].end = object_num * (t + 1) / thread_num;
+    }
+    p_cc_run_phase(tasks, thread_num, p_cc_init_phase);
+
+    // 按输入对划分: 连接采样的输入对
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].begin = pair_num * t / thread_num;
+        tasks[t].end = pair_num * (t + 1) / thread_num;
+        tasks[t].sampled = true;
+    }
+    p_cc_run_phase(tasks, thread_num, p_cc_link_phase);
+
+    // 按对象划分: 指针跳跃
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].begin = object_num * t / thread_num;
+        tasks[t].end = object_num * (t + 1) / thread_num;
+    }
+    p_cc_run_phase(tasks, thread_num, p_cc_compress_phase);
+
+    // 只有采样时才需要连接其余的输入对
+    if (stride > 1) {
+        for (int t = 0; t < thread_num; t++) {
+            tasks[t].begin = pair_num * t / thread_num;
+            tasks[t].end = pair_num * (t + 1) / thread_num;
+            tasks[t].sampled = false;
+        }
+        p_cc_run_phase(tasks, thread_num, p_cc_link_phase);
+
+        for (int t = 0; t < thread_num; t++) {
+            tasks[t].begin = object_num * t / thread_num;
+            tasks[t].end = object_num * (t + 1) / thread_num;
+        }
+        p_cc_run_phase(tasks, thread_num, p_cc_compress_phase);
+    }
+
+    p_cc_run_phase(tasks, thread_num, p_cc_count_phase);
+    labels->component_num = 0;
+    for (int t = 0; t < thread_num; t++) labels->component_num += tasks[t].root_num;
+    labels->labels = data;
+    labels->object_num = object_num;
+
+    free(tasks);
+    return labels;
+}
+
+void p_cc_delete_labels(struct cc_labels *labels) {
+    if (labels != NULL) {
+        free(labels->labels);
+        free(labels);
+    }
+    return;
+}
+
+/**
+ * @brief 批量判断输入对是否为新连接，结果与逐个处理输入对的算法相同。
+ *
+ * out_bitmap的格式与w_qunion_pc_h_process_batch相同，
+ * thread_num不大于0时使用所有在线的核，内存不足时返回false。
+ */
+bool p_cc_process_batch(int (*pairs)[2], size_t pair_num, size_t object_num, int thread_num, unsigned char *out_bitmap) {
+    if (thread_num <= 0) {
+        long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_num = cpu_num < 1 ? 1 : (int)cpu_num;
+    }
+
+    int *data = malloc(sizeof(*data) * object_num);
+    int *reservation = malloc(sizeof(*reservation) * object_num);
+    size_t *window = malloc(sizeof(*window) * P_CC_WINDOW);
+    int (*roots)[2] = malloc(sizeof(*roots) * P_CC_WINDOW);
+    struct p_cc_task *tasks = malloc(sizeof(*tasks) * thread_num);
+    if (data == NULL || reservation == NULL || window == NULL || roots == NULL || tasks == NULL) {
+        free(data);
+        free(reservation);
+        free(window);
+        free(roots);
+        free(tasks);
+        return false;
+    }
+
+    int init_thread_num = object_num / P_CC_MIN_CHUNK < thread_num ? object_num / P_CC_MIN_CHUNK + 1 : thread_num;
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].data = data;
+        tasks[t].pairs = pairs;
+        tasks[t].reservation = reservation;
+        tasks[t].window = window;
+        tasks[t].roots = roots;
+        tasks[t].out_bitmap = out_bitmap;
+        tasks[t].begin = object_num * t / init_thread_num;
+        tasks[t].end = object_num * (t + 1) / init_thread_num;
+    }
+    p_cc_run_phase(tasks, init_thread_num, p_cc_init_phase);
+    memset(out_bitmap, 0, (pair_num + 7) / 8);
+
+    size_t pending_num = 0, next = 0;
+    while (pending_num > 0 || next < pair_num) {
+        // 未完成的输入对已经在窗口的开头，按顺序补充新的输入对
+        while (pending_num < P_CC_WINDOW && next < pair_num) window[pending_num++] = next++;
+
+        int round_thread_num = pending_num / P_CC_MIN_WINDOW_CHUNK < thread_num ? pending_num / P_CC_MIN_WINDOW_CHUNK + 1 : thread_num;
+        for (int t = 0; t < round_thread_num; t++) {
+            tasks[t].begin = pending_num * t / round_thread_num;
+            tasks[t].end = pending_num * (t + 1) / round_thread_num;
+        }
+        if (round_thread_num == 1) {
+            p_cc_sequential_phase(&tasks[0]);
+            pending_num = 0;
+            continue;
+        }
+        p_cc_run_phase(tasks, round_thread_num, p_cc_reserve_phase);
+        p_cc_run_phase(tasks, round_thread_num, p_cc_commit_phase);
+
+        // 各线程的未完成的输入对已按顺序移到各自区间的开头，依次拼接
+        pending_num = 0;
+        for (int t = 0; t < round_thread_num; t++) {
+            memmove(&window[pending_num], &window[tasks[t].begin], sizeof(*window) * tasks[t].survivor_num);
+            pending_num += tasks[t].survivor_num;
+        }
+    }
+
+    free(data);
+    free(reservation);
+    free(window);
+    free(roots);
+    free(tasks);
+    return true;
+}
+
+/**
+ * @brief 让thread_num个线程各自执行phase，当前线程负责第0个任务以及创建失败的线程的任务。
+ */
+static void p_cc_run_phase(struct p_cc_task *tasks, int thread_num, void *(*phase)(void *)) {
+    pthread_t threads[thread_num];
+    bool started[thread_num];
+    for (int t = 0; t < thread_num; t++) {
+        started[t] = t > 0 && pthread_create(&threads[t], NULL, phase, &tasks[t]) == 0;
+    }
+    for (int t = 0; t < thread_num; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+        else phase(&tasks[t]);
+    }
+    return;
+}
+
+static void *p_cc_init_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    for (size_t i = task->begin; i < task->end; i++) task->data[i] = i;
+    if (task->reservation != NULL) {
+        for (size_t i = task->begin; i < task->end; i++) task->reservation[i] = INT_MAX;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 追溯根节点，同时以CAS进行路径减半，与Concurrent-quick-union算法的搜索操作相同。
+ */
+static int p_cc_find(int *data, int i) {
+    int parent, grandparent;
+    while ((parent = __atomic_load_n(&data[i], __ATOMIC_RELAXED)) != i) {
+        grandparent = __atomic_load_n(&data[parent], __ATOMIC_RELAXED);
+        if (grandparent != parent) {
+            __atomic_compare_exchange_n(&data[i], &parent, grandparent, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        i = grandparent;
+    }
+    return i;
+}
+
+/**
+ * @brief 连接两个对象，把序号较大的根节点连接到序号较小的根节点下。
+ */
+static void p_cc_link(int *data, int p, int q) {
+    // 两个对象的父节点相同时已经连接，指针跳跃之后大部分输入对在这里结束
+    if (__atomic_load_n(&data[p], __ATOMIC_RELAXED) == __atomic_load_n(&data[q], __ATOMIC_RELAXED)) return;
+    for (;;) {
+        int proot = p_cc_find(data, p), qroot = p_cc_find(data, q);
+        if (proot == qroot) return;
+        int high = proot > qroot ? proot : qroot;
+        int low = proot > qroot ? qroot : proot;
+        // CAS失败说明high已被其他线程连接到别的树下，重新追溯
+        if (__atomic_compare_exchange_n(&data[high], &high, low, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return;
+    }
+}
+
+static void *p_cc_link_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    int *data = task->data;
+    int (*pairs)[2] = task->pairs;
+    if (task->sampled) {
+        // 采样的输入对是序号为stride的倍数的输入对
+        size_t first = (task->begin + task->stride - 1) / task->stride * task->stride;
+        size_t distance = P_CC_PREFETCH_DISTANCE * task->stride;
+        for (size_t i = first; i < task->end; i += task->stride) {
+            if (i + distance < task->end) {
+                __builtin_prefetch(&data[pairs[i + distance][0]]);
+                __builtin_prefetch(&data[pairs[i + distance][1]]);
+            }
+            p_cc_link(data, pairs[i][0], pairs[i][1]);
+        }
+    } else {
+        for (size_t i = task->begin; i < task->end; i++) {
+            if (i % task->stride == 0) continue;
+            if (i + P_CC_PREFETCH_DISTANCE < task->end) {
+                __builtin_prefetch(&data[pairs[i + P_CC_PREFETCH_DISTANCE][0]]);
+                __builtin_prefetch(&data[pairs[i + P_CC_PREFETCH_DISTANCE][1]]);
+            }
+            p_cc_link(data, pairs[i][0], pairs[i][1]);
+        }
+    }
+    return NULL;
+}
+
+static void *p_cc_compress_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    int *data = task->data;
+    for (size_t i = task->begin; i < task->end; i++) {
+        if (i + P_CC_PREFETCH_DISTANCE < task->end) __builtin_prefetch(&data[data[i + P_CC_PREFETCH_DISTANCE]]);
+        int parent = __atomic_load_n(&data[i], __ATOMIC_RELAXED);
+        int grandparent;
+        while (parent != (grandparent = __atomic_load_n(&data[parent], __ATOMIC_RELAXED))) parent = grandparent;
+        __atomic_store_n(&data[i], parent, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 把根节点的预约值改为它与slot中的较小值。
+ */
+static void p_cc_reserve(int *reservation, int root, int slot) {
+    int current = __atomic_load_n(&reservation[root], __ATOMIC_RELAXED);
+    while (slot < current && !__atomic_compare_exchange_n(&reservation[root], &current, slot, true,
+                                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return;
+}
+
+static void *p_cc_reserve_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    int *data = task->data;
+    int (*pairs)[2] = task->pairs;
+    size_t *window = task->window;
+    for (size_t s = task->begin; s < task->end; s++) {
+        if (s + P_CC_PREFETCH_DISTANCE < task->end) {
+            __builtin_prefetch(&data[pairs[window[s + P_CC_PREFETCH_DISTANCE]][0]]);
+            __builtin_prefetch(&data[pairs[window[s + P_CC_PREFETCH_DISTANCE]][1]]);
+        }
+        int proot = p_cc_find(data, pairs[window[s]][0]);
+        int qroot = p_cc_find(data, pairs[window[s]][1]);
+        if (proot == qroot) {
+            task->roots[s][0] = -1;
+            continue;
+        }
+        task->roots[s][0] = proot;
+        task->roots[s][1] = qroot;
+        p_cc_reserve(task->reservation, proot, s);
+        p_cc_reserve(task->reservation, qroot, s);
+    }
+    return NULL;
+}
+
+static void *p_cc_commit_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    int *data = task->data, *reservation = task->reservation;
+    size_t survivor = task->begin;
+    for (size_t s = task->begin; s < task->end; s++) {
+        int proot = task->roots[s][0], qroot = task->roots[s][1];
+        if (proot < 0) continue;
+        // 其他持有者同时清除自己的预约时，读到的值也不会等于s
+        bool hold_p = __atomic_load_n(&reservation[proot], __ATOMIC_RELAXED) == (int)s;
+        bool hold_q = __atomic_load_n(&reservation[qroot], __ATOMIC_RELAXED) == (int)s;
+        if (!hold_p && !hold_q) {
+            task->window[survivor++] = task->window[s];
+            continue;
+        }
+        // 持有两个预约时与p_cc_link相同，把序号较大的根节点连接到序号较小的根节点下
+        if (hold_q && (!hold_p || proot < qroot)) __atomic_store_n(&data[qroot], proot, __ATOMIC_RELAXED);
+        else __atomic_store_n(&data[proot], qroot, __ATOMIC_RELAXED);
+        if (hold_p) __atomic_store_n(&reservation[proot], INT_MAX, __ATOMIC_RELAXED);
+        if (hold_q) __atomic_store_n(&reservation[qroot], INT_MAX, __ATOMIC_RELAXED);
+        size_t i = task->window[s];
+        __atomic_fetch_or(&task->out_bitmap[i / 8], 1U << (i % 8), __ATOMIC_RELAXED);
+    }
+    task->survivor_num = survivor - task->begin;
+    return NULL;
+}
+
+/**
+ * @brief 按顺序处理整个窗口，此时没有其他线程访问父节点数组。
+ */
+static void *p_cc_sequential_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    int *data = task->data;
+    int (*pairs)[2] = task->pairs;
+    size_t *window = task->window;
+    for (size_t s = task->begin; s < task->end; s++) {
+        if (s + P_CC_PREFETCH_DISTANCE < task->end) {
+            __builtin_prefetch(&data[pairs[window[s + P_CC_PREFETCH_DISTANCE]][0]]);
+            __builtin_prefetch(&data[pairs[window[s + P_CC_PREFETCH_DISTANCE]][1]]);
+        }
+        int proot = p_cc_find(data, pairs[window[s]][0]);
+        int qroot = p_cc_find(data, pairs[window[s]][1]);
+        if (proot == qroot) continue;
+        // 与p_cc_link相同，把序号较大的根节点连接到序号较小的根节点下
+        if (proot < qroot) data[qroot] = proot;
+        else data[proot] = qroot;
+        task->out_bitmap[window[s] / 8] |= 1U << (window[s] % 8);
+    }
+    return NULL;
+}
+
+static void *p_cc_count_phase(void *arg) {
+    struct p_cc_task *task = arg;
+    size_t root_num = 0;
+    for (size_t i = task->begin; i < task->end; i++) root_num += task->data[i] == (int)i;
+    task->root_num = root_num;
+    return NULL;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- ParallelConnectedComponents
+ ****************************************/
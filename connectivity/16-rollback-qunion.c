@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "connectivity.h"
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup RollbackQuickUnion
+ * @brief 连接问题算法16: Rollback-weighted-quick-union算法。
+ *
+ * ###改进#
+ *
+ * 有时需要试探性地连接一批输入对，例如判断"加入这些输入对后两个对象是否连通"，
+ * 得到结果后再撤销这些连接。
+ * 前面的算法只能事先复制整个存储结构，代价与对象数成正比，而与这批输入对的个数无关。
+ *
+ * 本算法在Weighted-quick-union算法的基础上记录每次联合，
+ * 从而能以与联合次数成正比的代价撤销最近的联合。
+ *
+ * ###数据结构#
+ *
+ * 在Weighted-quick-union算法的数据结构的基础上，增加一个撤销日志，
+ * 按联合的顺序记录每次被连接到另一个树下的根节点。
+ *
+ * 每次联合都使树的个数减少1，因此日志中最多有N-1项，
+ * 创建存储结构时一次分配完毕，联合时不需要扩容，也不会失败。
+ *
+ * ###算法描述#
+ *
+ * -# 搜索操作与联合操作
+ *
+ *    与Weighted-quick-union算法相同，联合时把被连接到下方的根节点追加到日志末尾。
+ *
+ *    本算法不能压缩路径: 压缩会修改联合之外的父节点，撤销时无法恢复。
+ *    不压缩路径时，节点的父节点只在它作为根节点被连接时修改一次，
+ *    撤销这次联合就能恢复原状。
+ *    按节点数联合保证了树的高度不超过lgN，因此不压缩路径的搜索仍是对数时间的。
+ *
+ * -# 检查点
+ *
+ *    rb_qunion_checkpoint返回当前日志的长度，作为检查点的标记。
+ *
+ * -# 回滚
+ *
+ *    rb_qunion_rollback按与联合相反的顺序撤销日志中标记之后的联合:
+ *    设被撤销的根节点为c，它的父节点为r，
+ *    则把c的父节点改回c本身，并从r的节点数中减去c的节点数。
+ *    c的节点数在联合时没有改变，不需要恢复。
+ *
+ *    回滚到某个检查点之后，在它之后创建的检查点的标记不再有效。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+static void rb_qunion_find_operation(const struct rollback_storage *storage, int p, int q, int *proot, int *qroot);
+static void rb_qunion_union_operation(struct rollback_storage *storage, int proot, int qroot);
+
+struct rollback_storage *rb_qunion_new_storage(size_t object_num) {
+    int *data = malloc(sizeof(*data) * object_num);
+    int *tree_size = malloc(sizeof(*tree_size) * object_num);
+    // 至少分配一项，使object_num为0时malloc的结果仍可以区分成功与失败
+    int *undo = malloc(sizeof(*undo) * (object_num > 0 ? object_num : 1));
+    struct rollback_storage *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && undo != NULL && storage != NULL) {
+        for (size_t i = 0; i < object_num; i++) {
+            data[i] = i;
+            tree_size[i] = 1;
+        }
+        storage->data = data;
+        storage->tree_size = tree_size;
+        storage->undo = undo;
+        storage->undo_num = 0;
+        storage->object_num = object_num;
+        storage->component_num = object_num;
+        return storage;
+    }
+    free(data);
+    free(tree_size);
+    free(undo);
+    free(storage);
+    return NULL;
+}
+
+void rb_qunion_delete_storage(struct rollback_storage *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage->tree_size);
+        free(storage->undo);
+        free(storage);
+    }
+    return;
+}
+
+bool rb_qunion_is_new_connection(struct rollback_storage *storage, int p, int q) {
+    int proot, qroot;
+    rb_qunion_find_operation(storage, p, q, &proot, &qroot);
+    if (proot == qroot) return false;
+    rb_qunion_union_operation(storage, proot, qroot);
+    return true;
+}
+
+/**
+ * @brief 返回p所在树的根节点，不修改存储结构。
+ */
+int rb_qunion_find(const struct rollback_storage *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+bool rb_qunion_connected(const struct rollback_storage *storage, int p, int q) {
+    return rb_qunion_find(storage, p) == rb_qunion_find(storage, q);
+}
+
+/**
+ * @brief 返回当前的检查点的标记，即此前联合的次数。
+ */
+size_t rb_qunion_checkpoint(const struct rollback_storage *storage) {
+    return storage->undo_num;
+}
+
+/**
+ * @brief 撤销检查点checkpoint之后的所有联合。
+ *
+ * checkpoint大于当前的联合次数时(例如已经回滚到更早的检查点)返回false，不做任何修改。
+ */
+bool rb_qunion_rollback(struct rollback_storage *storage, size_t checkpoint) {
+    if (checkpoint > storage->undo_num) return false;
+    while (storage->undo_num > checkpoint) {
+        int child = storage->undo[--storage->undo_num];
+        int root = storage->data[child];
+        storage->tree_size[root] -= storage->tree_size[child];
+        storage->data[child] = child;
+        storage->component_num++;
+    }
+    return true;
+}
+
+static void rb_qunion_find_operation(const struct rollback_storage *storage, int p, int q, int *proot, int *qroot) {
+    *proot = rb_qunion_find(storage, p);
+    *qroot = rb_qunion_find(storage, q);
+    return;
+}
+
+static void rb_qunion_union_operation(struct rollback_storage *storage, int proot, int qroot) {
+    if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        int tmp = proot;
+        proot = qroot;
+        qroot = tmp;
+    }
+    // 此时qroot所在的树较小，将其连接到proot下
+    CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
+    storage->data[qroot] = proot;
+    storage->tree_size[proot] += storage->tree_size[qroot];
+    storage->undo[storage->undo_num++] = qroot;
+    storage->component_num--;
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- RollbackQuickUnion
+ ****************************************/
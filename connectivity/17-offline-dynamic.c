@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "connectivity.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup OfflineDynamicConnectivity
+ * @brief 连接问题算法17: 离线动态连通性算法。
+ *
+ * ###改进#
+ *
+ * 前面的算法只能增加连接，不能删除。
+ * 连接被撤销时，唯一的办法是用剩余的输入对重新建立存储结构。
+ *
+ * 如果插入、删除和查询操作的序列事先已知(例如一批日志)，
+ * 可以用按时间分治的方法(Eppstein 1992)离线地回答所有查询，
+ * 每个操作的均摊代价是O(log Q lg N)，Q为查询的个数。
+ *
+ * ###算法描述#
+ *
+ * -# 连接的存在区间
+ *
+ *    每个连接从插入起、到删除为止存在，未被删除的连接一直存在到最后。
+ *    同一对对象可以被插入多次，删除时撤销最近一次尚未删除的插入，
+ *    删除不存在的连接不产生任何效果。
+ *    把所有插入和删除操作按(对象对, 时间)排序，同一对对象的操作就按时间排在一起，
+ *    依次匹配即可得到每个连接的存在区间。
+ *
+ *    只有查询操作需要回答，因此时间以查询为单位:
+ *    存在区间[插入, 删除)转换为其间的查询的序号区间，不含任何查询的连接直接忽略。
+ *
+ * -# 按时间分治
+ *
+ *    在查询的序号上建立线段树，每个存在区间被分解为O(log Q)个线段树节点，记录在这些节点上。
+ *    从根节点深度优先遍历线段树:
+ *    进入节点时，在Rollback-weighted-quick-union算法的存储结构上联合该节点上的所有连接，
+ *    到达叶节点时，从根节点到叶节点路径上的连接恰好是该查询时刻存在的全部连接，回答该查询，
+ *    离开节点时回滚到进入时的检查点。
+ *
+ *    每个连接被联合O(log Q)次，每次联合和查询的代价都是O(lg N)。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+/**
+ * @brief 一次插入或删除操作，用于匹配存在区间。
+ */
+struct od_event {
+    uint64_t key;               ///< 规范化的对象对，较小的对象在高32位
+    size_t time;                ///< 操作的序号
+};
+
+/**
+ * @brief 深度优先遍历线段树时共用的数据。
+ */
+struct od_context {
+    struct rollback_storage *uf;
+    size_t leaf_num;            ///< 线段树叶节点的个数，不小于查询个数的2的幂
+    size_t query_num;
+    const size_t *queries;      ///< 第i个查询的操作序号
+    const struct dynamic_operation *operations;
+    const size_t *node_begin;   ///< 节点i上的连接是edges[node_begin[i]]到edges[node_begin[i + 1] - 1]
+    int (*edges)[2];
+    unsigned char *out_bitmap;
+};
+
+static int od_compare_events(const void *a, const void *b) {
+    const struct od_event *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->time < y->time ? -1 : x->time > y->time;
+}
+
+static uint64_t od_key(int p, int q) {
+    return p < q ? (uint64_t)p << 32 | (uint32_t)q : (uint64_t)q << 32 | (uint32_t)p;
+}
+
+/**
+ * @brief 对线段树中覆盖查询区间[begin, end)的节点调用visit，与自底向上的线段树的区间分解相同。
+ */
+#define OD_FOR_EACH_NODE(leaf_num, begin, end, node, visit) \
+    do { \
+        size_t od_left = (begin) + (leaf_num), od_right = (end) + (leaf_num); \
+        for (; od_left < od_right; od_left >>= 1, od_right >>= 1) { \
+            if (od_left & 1) { size_t node = od_left++; visit; } \
+            if (od_right & 1) { size_t node = --od_right; visit; } \
+        } \
+    } while (0)
+
+/**
+ * @brief 深度优先遍历以node为根、覆盖查询[lo, hi)的子树。
+ */
+static void od_solve(struct od_context *context, size_t node, size_t lo, size_t hi) {
+    size_t checkpoint = rb_qunion_checkpoint(context->uf);
+    for (size_t e = context->node_begin[node]; e < context->node_begin[node + 1]; e++) {
+        rb_qunion_is_new_connection(context->uf, context->edges[e][0], context->edges[e][1]);
+    }
+    if (hi - lo == 1) {
+        size_t i = context->queries[lo];
+        const struct dynamic_operation *query = &context->operations[i];
+        if (rb_qunion_connected(context->uf, query->p, query->q)) context->out_bitmap[i / 8] |= 1U << (i % 8);
+    } else {
+        size_t mid = lo + (hi - lo) / 2;
+        od_solve(context, node * 2, lo, mid);
+        // 超出查询个数的部分没有叶节点需要回答
+        if (mid < context->query_num) od_solve(context, node * 2 + 1, mid, hi);
+    }
+    rb_qunion_rollback(context->uf, checkpoint);
+    return;
+}
+
+/**
+ * @brief 把插入和删除匹配为存在区间，ends[j]为第j个事件(必须是插入)对应的删除时间。
+ *
+ * events已按(对象对, 时间)排序，stack至少需要event_num项。
+ */
+static void od_match_events(const struct dynamic_operation *operations, size_t operation_num,
+                            const struct od_event *events, size_t event_num, size_t *ends, size_t *stack) {
+    size_t stack_num = 0;
+    for (size_t j = 0; j < event_num; j++) {
+        // 上一对对象未被删除的插入一直存在到最后
+        if (j > 0 && events[j].key != events[j - 1].key) {
+            while (stack_num > 0) ends[stack[--stack_num]] = operation_num;
+        }
+        if (operations[events[j].time].type == DYNAMIC_INSERT) stack[stack_num++] = j;
+        else if (stack_num > 0) ends[stack[--stack_num]] = events[j].time;
+    }
+    while (stack_num > 0) ends[stack[--stack_num]] = operation_num;
+    return;
+}
+
+/**
+ * @brief 把存在区间记录到线段树的节点上并回答所有查询，内存不足时返回false。
+ */
+static bool od_solve_batch(struct od_context *context, const struct od_event *events, size_t event_num,
+                           const size_t *ends, const size_t *query_before, size_t *node_begin) {
+    const struct dynamic_operation *operations = context->operations;
+    size_t leaf_num = context->leaf_num;
+
+    // 第一遍统计每个节点上的连接个数，第二遍填入连接
+    size_t edge_num = 0;
+    for (size_t j = 0; j < event_num; j++) {
+        if (operations[events[j].time].type != DYNAMIC_INSERT) continue;
+        size_t begin = query_before[events[j].time], end = query_before[ends[j]];
+        OD_FOR_EACH_NODE(leaf_num, begin, end, node, (node_begin[node + 1]++, edge_num++));
+    }
+    for (size_t node = 0; node < leaf_num * 2; node++) node_begin[node + 1] += node_begin[node];
+
+    int (*edges)[2] = malloc(sizeof(*edges) * (edge_num > 0 ? edge_num : 1));
+    size_t *cursor = malloc(sizeof(*cursor) * leaf_num * 2);
+    if (edges == NULL || cursor == NULL) {
+        free(edges);
+        free(cursor);
+        return false;
+    }
+    memcpy(cursor, node_begin, sizeof(*cursor) * leaf_num * 2);
+    for (size_t j = 0; j < event_num; j++) {
+        const struct dynamic_operation *insert = &operations[events[j].time];
+        if (insert->type != DYNAMIC_INSERT) continue;
+        size_t begin = query_before[events[j].time], end = query_before[ends[j]];
+        OD_FOR_EACH_NODE(leaf_num, begin, end, node, (edges[cursor[node]][0] = insert->p, edges[cursor[node]++][1] = insert->q));
+    }
+
+    context->node_begin = node_begin;
+    context->edges = edges;
+    od_solve(context, 1, 0, leaf_num);
+
+    free(edges);
+    free(cursor);
+    return true;
+}
+
+/**
+ * @brief 离线处理一批插入、删除和查询操作。
+ *
+ * out_bitmap至少需要(operation_num+7)/8个字节，
+ * 第i个操作是查询且两个对象当时已连接时，out_bitmap[i/8]的第i%8位为1，否则为0。
+ * 内存不足时返回false。
+ */
+bool od_process_batch(const struct dynamic_operation *operations, size_t operation_num, size_t object_num,
+                      unsigned char *out_bitmap) {
+    memset(out_bitmap, 0, (operation_num + 7) / 8);
+
+    size_t query_num = 0, event_num = 0;
+    for (size_t i = 0; i < operation_num; i++) {
+        if (operations[i].type == DYNAMIC_QUERY) query_num++;
+        else event_num++;
+    }
+    if (query_num == 0) return true;
+
+    size_t leaf_num = 1;
+    while (leaf_num < query_num) leaf_num *= 2;
+    // query_before[i]为第i个操作之前的查询个数
+    size_t *query_before = malloc(sizeof(*query_before) * (operation_num + 1));
+    size_t *queries = malloc(sizeof(*queries) * query_num);
+    struct od_event *events = malloc(sizeof(*events) * (event_num > 0 ? event_num : 1));
+    size_t *ends = malloc(sizeof(*ends) * (event_num > 0 ? event_num : 1));
+    size_t *stack = malloc(sizeof(*stack) * (event_num > 0 ? event_num : 1));
+    size_t *node_begin = calloc(leaf_num * 2 + 1, sizeof(*node_begin));
+    struct rollback_storage *uf = rb_qunion_new_storage(object_num);
+    bool ok = false;
+    if (query_before != NULL && queries != NULL && events != NULL && ends != NULL && stack != NULL
+        && node_begin != NULL && uf != NULL) {
+        query_num = event_num = 0;
+        for (size_t i = 0; i < operation_num; i++) {
+            query_before[i] = query_num;
+            if (operations[i].type == DYNAMIC_QUERY) queries[query_num++] = i;
+            else events[event_num++] = (struct od_event){od_key(operations[i].p, operations[i].q), i};
+        }
+        query_before[operation_num] = query_num;
+        qsort(events, event_num, sizeof(*events), od_compare_events);
+        od_match_events(operations, operation_num, events, event_num, ends, stack);
+
+        struct od_context context = {
+            .uf = uf, .leaf_num = leaf_num, .query_num = query_num, .queries = queries,
+            .operations = operations, .out_bitmap = out_bitmap
+        };
+        ok = od_solve_batch(&context, events, event_num, ends, query_before, node_begin);
+    }
+
+    free(query_before);
+    free(queries);
+    free(events);
+    free(ends);
+    free(stack);
+    free(node_begin);
+    rb_qunion_delete_storage(uf);
+    return ok;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- OfflineDynamicConnectivity
+ ****************************************/
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "connectivity.h"
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup VersionedQuickUnion
+ * @brief 连接问题算法18: Versioned-weighted-quick-union算法。
+ *
+ * ###改进#
+ *
+ * 前面的算法只能回答"此刻两个对象是否已连接"。
+ * 审计时还需要回答"处理完前t个输入对时两个对象是否已连接"和"两个对象从第几个输入对起连接"，
+ * 前面的算法只能从头重放前t个输入对，代价与t成正比。
+ *
+ * 本算法在Weighted-quick-union算法的基础上为每次联合记录时间戳，
+ * 处理完所有输入对之后，任意历史时刻的查询都只需要对数时间。
+ *
+ * ###数据结构#
+ *
+ * 在Weighted-quick-union算法的数据结构的基础上，增加一个时间戳数组stamp，
+ * 节点被连接到另一个树下时，stamp记录此时的版本，即包括这个输入对在内已处理的输入对个数。
+ * 根节点的时间戳为VR_QUNION_NEVER。
+ *
+ * ###算法描述#
+ *
+ * -# 联合操作
+ *
+ *    每处理一个输入对，无论是否产生新连接，版本都加1。
+ *    其余与Weighted-quick-union算法相同，只是被连接到下方的根节点记录当前的版本。
+ *
+ *    与Rollback-weighted-quick-union算法相同，本算法不能压缩路径:
+ *    节点的父节点只在它作为根节点被连接时修改一次，因此版本v时的树恰好是
+ *    当前的树中只保留时间戳不大于v的父节点链接的结果。
+ *    按节点数联合保证了树的高度不超过lgN。
+ *
+ * -# 历史版本的搜索vr_qunion_find_at
+ *
+ *    沿父节点向上追溯，遇到时间戳大于v的节点即停止，该节点就是版本v时的根节点。
+ *    vr_qunion_connected_at比较两个对象在版本v时的根节点。
+ *
+ * -# 连接时刻vr_qunion_connected_since
+ *
+ *    节点只在作为根节点时被连接，此前它下方的所有链接都已存在，
+ *    因此沿任何路径向上，时间戳严格递增。
+ *    两个对象在版本v时连接，当且仅当它们到最近公共祖先的路径上的时间戳都不大于v，
+ *    即连接的版本是这两段路径上时间戳的最大值。
+ *
+ *    从两个对象同时向上追溯，每次前进时间戳较小的一方:
+ *    由于时间戳向上递增，最近公共祖先的时间戳大于它下方所有节点的时间戳，
+ *    所以先到达最近公共祖先的一方会停在那里等待另一方，
+ *    两方相遇时最后经过的时间戳就是最大值。
+ *    两方都到达根节点而仍不相遇时，两个对象尚未连接。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+static void vr_qunion_union_operation(struct versioned_storage *storage, int proot, int qroot);
+
+struct versioned_storage *vr_qunion_new_storage(size_t object_num) {
+    int *data = malloc(sizeof(*data) * object_num);
+    int *tree_size = malloc(sizeof(*tree_size) * object_num);
+    size_t *stamp = malloc(sizeof(*stamp) * object_num);
+    struct versioned_storage *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && stamp != NULL && storage != NULL) {
+        for (size_t i = 0; i < object_num; i++) {
+            data[i] = i;
+            tree_size[i] = 1;
+            stamp[i] = VR_QUNION_NEVER;
+        }
+        storage->data = data;
+        storage->tree_size = tree_size;
+        storage->stamp = stamp;
+        storage->version = 0;
+        storage->object_num = object_num;
+        return storage;
+    }
+    free(data);
+    free(tree_size);
+    free(stamp);
+    free(storage);
+    return NULL;
+}
+
+void vr_qunion_delete_storage(struct versioned_storage *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage->tree_size);
+        free(storage->stamp);
+        free(storage);
+    }
+    return;
+}
+
+/**
+ * @brief 处理下一个输入对，版本加1。
+ */
+bool vr_qunion_is_new_connection(struct versioned_storage *storage, int p, int q) {
+    storage->version++;
+    int proot = vr_qunion_find(storage, p);
+    int qroot = vr_qunion_find(storage, q);
+    if (proot == qroot) return false;
+    vr_qunion_union_operation(storage, proot, qroot);
+    return true;
+}
+
+/**
+ * @brief 返回当前的版本，即已处理的输入对个数。
+ */
+size_t vr_qunion_version(const struct versioned_storage *storage) {
+    return storage->version;
+}
+
+int vr_qunion_find(const struct versioned_storage *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+bool vr_qunion_connected(const struct versioned_storage *storage, int p, int q) {
+    return vr_qunion_find(storage, p) == vr_qunion_find(storage, q);
+}
+
+/**
+ * @brief 返回处理完前version个输入对时p所在树的根节点。
+ *
+ * version大于当前版本时与当前版本相同。
+ */
+int vr_qunion_find_at(const struct versioned_storage *storage, int p, size_t version) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i] && storage->stamp[i] <= version; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断处理完前version个输入对时两个对象是否已连接。
+ */
+bool vr_qunion_connected_at(const struct versioned_storage *storage, int p, int q, size_t version) {
+    return vr_qunion_find_at(storage, p, version) == vr_qunion_find_at(storage, q, version);
+}
+
+/**
+ * @brief 返回两个对象开始连接的版本，即使它们连接的输入对的序号加1。
+ *
+ * p与q相同时返回0，尚未连接时返回VR_QUNION_NEVER。
+ */
+size_t vr_qunion_connected_since(const struct versioned_storage *storage, int p, int q) {
+    size_t since = 0;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    while (p != q) {
+        if (storage->stamp[p] < storage->stamp[q]) {
+            since = storage->stamp[p];
+            p = storage->data[p];
+        } else if (storage->stamp[q] != VR_QUNION_NEVER) {
+            since = storage->stamp[q];
+            q = storage->data[q];
+        } else {
+            // 两方都是根节点
+            since = VR_QUNION_NEVER;
+            break;
+        }
+        CONNECTIVITY_STATS_HOP();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return since;
+}
+
+static void vr_qunion_union_operation(struct versioned_storage *storage, int proot, int qroot) {
+    if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        int tmp = proot;
+        proot = qroot;
+        qroot = tmp;
+    }
+    // 此时qroot所在的树较小，将其连接到proot下
+    CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
+    storage->data[qroot] = proot;
+    storage->tree_size[proot] += storage->tree_size[qroot];
+    storage->stamp[qroot] = storage->version;
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- VersionedQuickUnion
+ ****************************************/
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "connectivity.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup PairText
+ * @brief 连接问题输入19: 文本输入对的解析。
+ *
+ * ###改进#
+ *
+ * 各算法文件中的DOC_COMPILE版main函数用scanf读取输入对，
+ * 每秒只能解析几百万个输入对，远低于算法本身的速度。
+ *
+ * 本文件把connectivity-stream中手写的整数解析循环独立出来，
+ * 直接扫描调用者给出的缓冲区，不经过stdio，也不在出错时退出进程，
+ * 而是返回错误的种类和位置，由调用者决定如何报告。
+ *
+ * ###输入格式#
+ *
+ * 与DOC_COMPILE版main函数相同: 以空白字符分隔的非负十进制整数，每两个组成一个输入对，
+ * 每个整数都必须小于object_num。
+ *
+ * ###使用方法#
+ *
+ * 输入可以分多次交给pair_text_parse，但每次给出的区间末尾不能截断一个整数，
+ * 例如按块读入时，把每块末尾最后一个空白字符之后的部分留到下一块开头。
+ * 一个输入对的两个整数可以分属两次调用，前一个整数保存在pending中。
+ *
+ * 解析出的输入对存入调用者提供的pairs数组，
+ * 数组满时pair_text_parse返回PAIR_TEXT_FULL，并给出停止的位置，
+ * 调用者处理完数组中的输入对、把pair_len清零后，从停止的位置继续解析。
+ *
+ * 全部输入解析完后，pending不为负数说明整数的个数是奇数，最后一个整数没有配对。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+void pair_text_init(struct pair_text_parser *parser, int object_num, int (*pairs)[2], size_t pair_capacity) {
+    parser->pairs = pairs;
+    parser->pair_capacity = pair_capacity;
+    parser->pair_len = 0;
+    parser->object_num = object_num;
+    parser->pending = -1;
+    parser->offset = 0;
+    return;
+}
+
+bool pair_text_is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief 解析[begin, end)中的整数，直到区间结束、pairs数组已满或出错。
+ *
+ * *stop为停止的位置: 正常结束时为end，数组已满时为下一个未解析的字节，出错时为出错的整数或字符的开头。
+ * 返回时parser->offset为此前所有调用解析过的字节数加上本次的begin到*stop，出错时即为出错的位置。
+ */
+enum pair_text_status pair_text_parse(struct pair_text_parser *parser, const char *begin, const char *end, const char **stop) {
+    const char *cursor = begin;
+    long long limit = parser->object_num;
+    enum pair_text_status status = PAIR_TEXT_OK;
+
+    while (cursor < end) {
+        unsigned int c = (unsigned char)*cursor;
+        if (c - '0' < 10) {
+            long long value = c - '0';
+            const char *start = cursor++;
+            // 一旦不小于limit就停止累加，因此任意长的数字串都不会溢出
+            while (cursor < end && (c = (unsigned char)*cursor - '0') < 10) {
+                value = value * 10 + c;
+                if (value >= limit) break;
+                cursor++;
+            }
+            if (value >= limit) {
+                cursor = start;
+                status = PAIR_TEXT_OUT_OF_RANGE;
+                break;
+            }
+
+            if (parser->pending < 0) {
+                parser->pending = value;
+            } else {
+                parser->pairs[parser->pair_len][0] = parser->pending;
+                parser->pairs[parser->pair_len][1] = value;
+                parser->pending = -1;
+                if (++parser->pair_len == parser->pair_capacity) {
+                    status = PAIR_TEXT_FULL;
+                    break;
+                }
+            }
+        } else if (pair_text_is_space(c)) {
+            cursor++;
+        } else {
+            status = PAIR_TEXT_INVALID_CHARACTER;
+            break;
+        }
+    }
+    parser->offset += cursor - begin;
+    *stop = cursor;
+    return status;
+}
+
+/**
+ * @brief 返回错误的描述，status为PAIR_TEXT_OK或PAIR_TEXT_FULL时返回NULL。
+ */
+const char *pair_text_error(enum pair_text_status status) {
+    switch (status) {
+    case PAIR_TEXT_OUT_OF_RANGE:
+        return "object out of range";
+    case PAIR_TEXT_INVALID_CHARACTER:
+        return "invalid character";
+    default:
+        return NULL;
+    }
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- PairText
+ ****************************************/
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -228,16 +229,38 @@ bool qunion_is_new_connection(int *storage, int p, int q) {
     return true;
 }
 
+/**
+ * @brief 返回p所在树的根节点，不修改存储结构。
+ */
+int qunion_find(const int *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage[i]; i = storage[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断p与q是否已连接，不进行联合操作。
+ */
+bool qunion_connected(const int *storage, int p, int q) {
+    return qunion_find(storage, p) == qunion_find(storage, q);
+}
+
 static void qunion_find_operation(int *storage, int p, int q, int *proot, int *qroot) {
     int i;
-    for (i = p; i != storage[i]; i = storage[i]);
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage[i]; i = storage[i]) CONNECTIVITY_STATS_HOP();
     *proot = i;
-    for (i = q; i != storage[i]; i = storage[i]);
+    CONNECTIVITY_STATS_FIND_END();
+    for (i = q; i != storage[i]; i = storage[i]) CONNECTIVITY_STATS_HOP();
     *qroot = i;
+    CONNECTIVITY_STATS_FIND_END();
     return;
 }
 
 static void qunion_union_operation(int *storage, int proot, int qroot) {
+    CONNECTIVITY_STATS_UNION(0);
     storage[proot] = qroot;
     return;
 }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -108,6 +109,21 @@
  * - 逻辑图
  * @dotfile weighted-quick-union-graph-5.gv
  * 
+ * ###连通分量#
+ * 
+ * 除了判断输入对是否为新连接，使用者还常常需要知道"一共有多少个连通分量"、
+ * "p所在的连通分量有多大"以及"p所在的连通分量有哪些对象"。
+ * 直接从存储数组中回答这些问题都需要扫描整个数组。
+ * 
+ * 三种加权算法(Weighted-quick-union及其两种路径压缩版本)的存储结构为此额外维护:
+ * - 连通分量的个数component_num: 初始为N，每次联合减1。
+ * - 连通分量的大小: 就是根节点的树节点计数，不需要额外的空间。
+ * - 一个长度为N的next数组: 同一个连通分量中的对象由next串成一个环，初始时每个对象自成一环。
+ *   联合两个树时，交换两个根节点的next，两个环就拼接成了一个环，只需常数时间。
+ *   从p出发沿着next走一圈即可列出p所在连通分量的所有对象，耗时与该分量的大小成正比，而不是O(N)。
+ * 
+ * w_qunion_component_count、w_qunion_component_size和w_qunion_component_members
+ * 对三种加权算法的存储结构都适用，它们只读取存储结构，不进行路径压缩。
  * 
  * @{
  ****************************************/
@@ -212,16 +228,24 @@ static void w_qunion_union_operation(struct storage_with_tree_size *storage, int
 struct storage_with_tree_size *w_qunion_new_storage(size_t object_num) {
     int *data = malloc(sizeof(*data) * object_num);
     int *tree_size = malloc(sizeof(*tree_size) * object_num);
-    if (data != NULL && tree_size != NULL) {
+    int *next = malloc(sizeof(*next) * object_num);
+    struct storage_with_tree_size *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && next != NULL && storage != NULL) {
         for (int i = 0; i < object_num; i++) {
             data[i] = i;
             tree_size[i] = 1;
+            next[i] = i;
         }
-        struct storage_with_tree_size *storage = malloc(sizeof(*storage));
         storage->data = data;
         storage->tree_size = tree_size;
+        storage->next = next;
+        storage->component_num = object_num;
         return storage;
     }
+    free(data);
+    free(tree_size);
+    free(next);
+    free(storage);
     return NULL;
 }
 
@@ -229,6 +253,7 @@ void w_qunion_delete_storage(struct storage_with_tree_size *storage) {
     if (storage != NULL) {
         free(storage->data);
         free(storage->tree_size);
+        free(storage->next);
         free(storage);
     }
     return;
@@ -242,20 +267,82 @@ bool w_qunion_is_new_connection(struct storage_with_tree_size *storage, int p, i
     return true;
 }
 
-static void w_qunion_find_operation(struct storage_with_tree_size *storage, int p, int q, int *proot, int *qroot) {
+/**
+ * @brief 当前连通分量的个数。
+ */
+size_t w_qunion_component_count(const struct storage_with_tree_size *storage) {
+    return storage->component_num;
+}
+
+/**
+ * @brief p所在连通分量的对象个数。
+ */
+int w_qunion_component_size(const struct storage_with_tree_size *storage, int p) {
     int i;
     for (i = p; i != storage->data[i]; i = storage->data[i]);
+    return storage->tree_size[i];
+}
+
+/**
+ * @brief 将p所在连通分量的所有对象写入members，返回对象个数，从p开始列出。
+ *
+ * members至少需要w_qunion_component_size(storage, p)个元素的空间。
+ * 存储结构不维护next环时返回-1。
+ */
+int w_qunion_component_members(const struct storage_with_tree_size *storage, int p, int *members) {
+    if (storage->next == NULL) return -1;
+    int member_num = 0, i = p;
+    do {
+        members[member_num++] = i;
+        i = storage->next[i];
+    } while (i != p);
+    return member_num;
+}
+
+/**
+ * @brief 返回p所在树的根节点，不修改存储结构。
+ */
+int w_qunion_find(const struct storage_with_tree_size *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断p与q是否已连接，不进行联合操作。
+ */
+bool w_qunion_connected(const struct storage_with_tree_size *storage, int p, int q) {
+    return w_qunion_find(storage, p) == w_qunion_find(storage, q);
+}
+
+static void w_qunion_find_operation(struct storage_with_tree_size *storage, int p, int q, int *proot, int *qroot) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *proot = i;
-    for (i = q; i != storage->data[i]; i = storage->data[i]);
+    CONNECTIVITY_STATS_FIND_END();
+    for (i = q; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *qroot = i;
+    CONNECTIVITY_STATS_FIND_END();
     return;
 }
 
 static void w_qunion_union_operation(struct storage_with_tree_size *storage, int proot, int qroot) {
+    storage->component_num--;
+    // 交换两个根节点的next即可把两个环拼接成一个
+    if (storage->next != NULL) {
+        int next = storage->next[proot];
+        storage->next[proot] = storage->next[qroot];
+        storage->next[qroot] = next;
+    }
     if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[proot]);
         storage->data[proot] = qroot;
         storage->tree_size[qroot] += storage->tree_size[proot];
     } else {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
         storage->data[qroot] = proot;
         storage->tree_size[proot] += storage->tree_size[qroot];
     }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -50,6 +51,17 @@
  * 
  * 容易从Weighted-quick-union算法的状态迁移推得，略。
  * 
+ * ###查询操作#
+ * 
+ * 每个算法除了is_new_connection以外，还提供只查询、不联合的find和connected。
+ * 使用路径压缩的算法的find和connected仍会压缩追溯经过的路径，
+ * 这对之后的查询有利，但每次查询都可能写入存储数组，
+ * 多个线程同时查询时既会互相使对方的cache line失效，也不安全。
+ * 
+ * 因此这些算法另外提供不压缩路径的find_readonly和connected_readonly，
+ * 它们只读取存储结构，在没有线程修改存储结构时，可以由任意多个线程同时调用，
+ * 适合以查询为主、存储结构很少变化的场景。
+ * 
  * @{
  ****************************************/
 
@@ -143,16 +155,24 @@ static void w_qunion_pc_union_operation(struct storage_with_tree_size *storage,
 struct storage_with_tree_size *w_qunion_pc_new_storage(size_t object_num) {
     int *data = malloc(sizeof(*data) * object_num);
     int *tree_size = malloc(sizeof(*tree_size) * object_num);
-    if (data != NULL && tree_size != NULL) {
+    int *next = malloc(sizeof(*next) * object_num);
+    struct storage_with_tree_size *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && next != NULL && storage != NULL) {
         for (int i = 0; i < object_num; i++) {
             data[i] = i;
             tree_size[i] = 1;
+            next[i] = i;
         }
-        struct storage_with_tree_size *storage = malloc(sizeof(*storage));
         storage->data = data;
         storage->tree_size = tree_size;
+        storage->next = next;
+        storage->component_num = object_num;
         return storage;
     }
+    free(data);
+    free(tree_size);
+    free(next);
+    free(storage);
     return NULL;
 }
 
@@ -160,6 +180,7 @@ void w_qunion_pc_delete_storage(struct storage_with_tree_size *storage) {
     if (storage != NULL) {
         free(storage->data);
         free(storage->tree_size);
+        free(storage->next);
         free(storage);
     }
     return;
@@ -173,24 +194,72 @@ bool w_qunion_pc_is_new_connection(struct storage_with_tree_size *storage, int p
     return true;
 }
 
+/**
+ * @brief 返回p所在树的根节点，并压缩追溯经过的路径。
+ */
+int w_qunion_pc_find(struct storage_with_tree_size *storage, int p) {
+    int i, root, original_parent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (root = p; root != storage->data[root]; root = storage->data[root]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    i = p;
+    while (i != storage->data[i]) {
+        original_parent = storage->data[i];
+        storage->data[i] = root;
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
+        i = original_parent;
+    }
+    return root;
+}
+
+/**
+ * @brief 不进行路径压缩的find，不修改存储结构，可以由多个线程同时调用。
+ */
+int w_qunion_pc_find_readonly(const struct storage_with_tree_size *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断p与q是否已连接，进行路径压缩，但不进行联合操作。
+ */
+bool w_qunion_pc_connected(struct storage_with_tree_size *storage, int p, int q) {
+    return w_qunion_pc_find(storage, p) == w_qunion_pc_find(storage, q);
+}
+
+/**
+ * @brief 不进行路径压缩的connected，不修改存储结构，可以由多个线程同时调用。
+ */
+bool w_qunion_pc_connected_readonly(const struct storage_with_tree_size *storage, int p, int q) {
+    return w_qunion_pc_find_readonly(storage, p) == w_qunion_pc_find_readonly(storage, q);
+}
+
 static void w_qunion_pc_find_operation(struct storage_with_tree_size *storage, int p, int q, int *proot, int *qroot) {
     int i, original_parent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
     
-    for (i = p; i != storage->data[i]; i = storage->data[i]);
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *proot = i;
+    CONNECTIVITY_STATS_FIND_END();
     i = p;
     while (i != storage->data[i]) {
         original_parent = storage->data[i];
         storage->data[i] = *proot;
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
         i = original_parent;
     }
     
-    for (i = q; i != storage->data[i]; i = storage->data[i]);
+    for (i = q; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *qroot = i;
+    CONNECTIVITY_STATS_FIND_END();
     i = q;
     while (i != storage->data[i]) {
         original_parent = storage->data[i];
         storage->data[i] = *proot;
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
         i = original_parent;
     }
     
@@ -198,10 +267,19 @@ static void w_qunion_pc_find_operation(struct storage_with_tree_size *storage, i
 }
 
 static void w_qunion_pc_union_operation(struct storage_with_tree_size *storage, int proot, int qroot) {
+    storage->component_num--;
+    // 交换两个根节点的next即可把两个环拼接成一个
+    if (storage->next != NULL) {
+        int next = storage->next[proot];
+        storage->next[proot] = storage->next[qroot];
+        storage->next[qroot] = next;
+    }
     if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[proot]);
         storage->data[proot] = qroot;
         storage->tree_size[qroot] += storage->tree_size[proot];
     } else {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
         storage->data[qroot] = proot;
         storage->tree_size[proot] += storage->tree_size[qroot];
     }
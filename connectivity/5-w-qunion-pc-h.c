@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -18,6 +19,18 @@
  * 
  * 相比普通的路径压缩，此方法省去了压缩路径所需的遍历(减半压缩在追溯过程中就能完成)。
  * 
+ * ###批量处理#
+ * 
+ * 对象数量远大于缓存容量时，随机输入对的每次追溯几乎都要从内存读取数据，
+ * 此时算法的耗时主要花在等待内存上，而不是计算上。
+ * 
+ * 相邻的输入对之间通常没有依赖关系，
+ * 因此w_qunion_pc_h_process_batch一次接受一批输入对，
+ * 在处理当前输入对的同时，预取(prefetch)后面第W_QUNION_PC_H_PREFETCH_DISTANCE个输入对的两个对象，
+ * 以及后面第W_QUNION_PC_H_PREFETCH_DISTANCE/2个输入对的两个对象的父节点，
+ * 让多个输入对的内存访问重叠进行。
+ * 处理结果以位图的形式输出，第i个输入对是新连接时，位图的第i位为1。
+ * 
  * ###状态迁移#
  * 
  * 容易从Weighted-quick-union算法的状态迁移推得，略。
@@ -92,19 +105,32 @@ int main()
 static void w_qunion_pc_h_find_operation(struct storage_with_tree_size *storage, int p, int q, int *proot, int *qroot);
 static void w_qunion_pc_h_union_operation(struct storage_with_tree_size *storage, int proot, int qroot);
 
+/**
+ * @brief 批量处理时预取的距离(以输入对为单位)。
+ */
+#define W_QUNION_PC_H_PREFETCH_DISTANCE 16
+
 struct storage_with_tree_size *w_qunion_pc_h_new_storage(size_t object_num) {
     int *data = malloc(sizeof(*data) * object_num);
     int *tree_size = malloc(sizeof(*tree_size) * object_num);
-    if (data != NULL && tree_size != NULL) {
+    int *next = malloc(sizeof(*next) * object_num);
+    struct storage_with_tree_size *storage = malloc(sizeof(*storage));
+    if (data != NULL && tree_size != NULL && next != NULL && storage != NULL) {
         for (int i = 0; i < object_num; i++) {
             data[i] = i;
             tree_size[i] = 1;
+            next[i] = i;
         }
-        struct storage_with_tree_size *storage = malloc(sizeof(*storage));
         storage->data = data;
         storage->tree_size = tree_size;
+        storage->next = next;
+        storage->component_num = object_num;
         return storage;
     }
+    free(data);
+    free(tree_size);
+    free(next);
+    free(storage);
     return NULL;
 }
 
@@ -112,6 +138,7 @@ void w_qunion_pc_h_delete_storage(struct storage_with_tree_size *storage) {
     if (storage != NULL) {
         free(storage->data);
         free(storage->tree_size);
+        free(storage->next);
         free(storage);
     }
     return;
@@ -125,27 +152,121 @@ bool w_qunion_pc_h_is_new_connection(struct storage_with_tree_size *storage, int
     return true;
 }
 
+/**
+ * @brief 批量判断输入对是否为新连接。
+ * 
+ * out_bitmap至少需要(pair_num+7)/8个字节，
+ * 第i个输入对是新连接时，out_bitmap[i/8]的第i%8位为1，否则为0。
+ */
+void w_qunion_pc_h_process_batch(struct storage_with_tree_size *storage, int (*pairs)[2], size_t pair_num, unsigned char *out_bitmap) {
+    const size_t distance = W_QUNION_PC_H_PREFETCH_DISTANCE;
+    int *data = storage->data;
+    unsigned char bits = 0;
+    int proot, qroot;
+
+    for (size_t i = 0; i < pair_num; i++) {
+        // 预取远处输入对的对象
+        if (i + distance < pair_num) {
+            __builtin_prefetch(&data[pairs[i + distance][0]], 1);
+            __builtin_prefetch(&data[pairs[i + distance][1]], 1);
+        }
+        // 较近的输入对的对象此时应已在缓存中，继续预取它们的父节点
+        if (i + distance / 2 < pair_num) {
+            __builtin_prefetch(&data[data[pairs[i + distance / 2][0]]], 1);
+            __builtin_prefetch(&data[data[pairs[i + distance / 2][1]]], 1);
+        }
+
+        w_qunion_pc_h_find_operation(storage, pairs[i][0], pairs[i][1], &proot, &qroot);
+        if (proot != qroot) {
+            w_qunion_pc_h_union_operation(storage, proot, qroot);
+            bits |= 1U << (i % 8);
+        }
+
+        if (i % 8 == 7 || i == pair_num - 1) {
+            out_bitmap[i / 8] = bits;
+            bits = 0;
+        }
+    }
+    return;
+}
+
+/**
+ * @brief 返回p所在树的根节点，并以路径减半的方式压缩追溯经过的路径。
+ */
+int w_qunion_pc_h_find(struct storage_with_tree_size *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) {
+        storage->data[i] = storage->data[storage->data[i]];
+        CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 不进行路径压缩的find，不修改存储结构，可以由多个线程同时调用。
+ */
+int w_qunion_pc_h_find_readonly(const struct storage_with_tree_size *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断p与q是否已连接，进行路径压缩，但不进行联合操作。
+ */
+bool w_qunion_pc_h_connected(struct storage_with_tree_size *storage, int p, int q) {
+    return w_qunion_pc_h_find(storage, p) == w_qunion_pc_h_find(storage, q);
+}
+
+/**
+ * @brief 不进行路径压缩的connected，不修改存储结构，可以由多个线程同时调用。
+ */
+bool w_qunion_pc_h_connected_readonly(const struct storage_with_tree_size *storage, int p, int q) {
+    return w_qunion_pc_h_find_readonly(storage, p) == w_qunion_pc_h_find_readonly(storage, q);
+}
+
 static void w_qunion_pc_h_find_operation(struct storage_with_tree_size *storage, int p, int q, int *proot, int *qroot) {
     int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
     
     for (i = p; i != storage->data[i]; i = storage->data[i]) {
         storage->data[i] = storage->data[storage->data[i]];
+        CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
     }
     *proot = i;
+    CONNECTIVITY_STATS_FIND_END();
     
     for (i = q; i != storage->data[i]; i = storage->data[i]) {
         storage->data[i] = storage->data[storage->data[i]];
+        CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
     }
     *qroot = i;
+    CONNECTIVITY_STATS_FIND_END();
     
     return;
 }
 
 static void w_qunion_pc_h_union_operation(struct storage_with_tree_size *storage, int proot, int qroot) {
+    storage->component_num--;
+    // 交换两个根节点的next即可把两个环拼接成一个
+    if (storage->next != NULL) {
+        int next = storage->next[proot];
+        storage->next[proot] = storage->next[qroot];
+        storage->next[qroot] = next;
+    }
     if (storage->tree_size[proot] < storage->tree_size[qroot]) {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[proot]);
         storage->data[proot] = qroot;
         storage->tree_size[qroot] += storage->tree_size[proot];
     } else {
+        CONNECTIVITY_STATS_UNION(storage->tree_size[qroot]);
         storage->data[qroot] = proot;
         storage->tree_size[proot] += storage->tree_size[qroot];
     }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "connectivity.h"
+#include "connectivity-stats.h"
 
 /****************************************
  * @ingroup Connectivity
@@ -140,16 +141,38 @@ bool h_qunion_is_new_connection(struct storage_with_tree_height *storage, int p,
     return true;
 }
 
+/**
+ * @brief 返回p所在树的根节点，不修改存储结构。
+ */
+int h_qunion_find(const struct storage_with_tree_height *storage, int p) {
+    int i;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 判断p与q是否已连接，不进行联合操作。
+ */
+bool h_qunion_connected(const struct storage_with_tree_height *storage, int p, int q) {
+    return h_qunion_find(storage, p) == h_qunion_find(storage, q);
+}
+
 static void h_qunion_find_operation(struct storage_with_tree_height *storage, int p, int q, int *proot, int *qroot) {
     int i;
-    for (i = p; i != storage->data[i]; i = storage->data[i]);
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (i = p; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *proot = i;
-    for (i = q; i != storage->data[i]; i = storage->data[i]);
+    CONNECTIVITY_STATS_FIND_END();
+    for (i = q; i != storage->data[i]; i = storage->data[i]) CONNECTIVITY_STATS_HOP();
     *qroot = i;
+    CONNECTIVITY_STATS_FIND_END();
     return;
 }
 
 static void h_qunion_union_operation(struct storage_with_tree_height *storage, int proot, int qroot) {
+    CONNECTIVITY_STATS_UNION(0);
     if (storage->tree_height[proot] < storage->tree_height[qroot]) {
         storage->data[proot] = qroot;
     } else if (storage->tree_height[proot] > storage->tree_height[qroot]) {
@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <string.h>
+#include "uf-engine.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup UnionFindEngine
+ * @brief 连接问题算法7: 通用Union-find引擎。
+ *
+ * ###改进#
+ *
+ * 算法2~6的实现各自拥有一套存储结构和初始化、删除、搜索、联合函数，
+ * 它们的差别只有两处:
+ * -# 联合操作如何选择新的根节点(连接策略)。
+ * -# 搜索操作是否以及如何压缩路径(压缩策略)。
+ *
+ * 本引擎将这两处差别提取为两个参数:
+ * - 连接策略: 不加权(none)、按节点数(size)、按高度(height)、按秩(rank)。
+ * - 压缩策略: 不压缩(none)、完全压缩(full)、减半压缩(halving)、分裂压缩(splitting)。
+ *
+ * 两个参数都是编译期常量，搜索和联合操作都是头文件中的always_inline函数，
+ * 因此编译器会为每一种组合生成一段完整内联的循环，
+ * 既没有函数指针调用，也没有按策略分支的开销。
+ *
+ * ###分裂路径压缩#
+ *
+ * 分裂路径压缩(path splitting)与减半路径压缩类似，
+ * 也是在追溯根节点的过程中把节点连接到其祖父节点上，
+ * 区别在于减半压缩每次跳过一个节点，只修改路径上一半的节点，
+ * 而分裂压缩逐个前进，修改路径上的每一个节点，
+ * 结果是原路径被分裂成两条长度各为一半的路径。
+ *
+ * ###按秩连接#
+ *
+ * 不压缩路径时，Heighted-quick-union算法记录的高度就是树的真实高度。
+ * 压缩路径后，树的高度可能下降，而记录的高度却不会随之更新，
+ * 此时记录值只是树高的上界，习惯上称为秩(rank)。
+ * 两者的更新规则完全相同，本引擎分别保留两个名称，仅用于区分语义。
+ *
+ * ###节点排列方式#
+ *
+ * Weighted-quick-union算法将父节点和树的节点数分别存放在两个数组中，
+ * 联合操作需要读写两个根节点各自的父节点和节点数，
+ * 在对象数量远大于缓存容量时，这意味着每个根节点都要访问两条相距很远的cache line。
+ *
+ * 本引擎允许在创建存储时选择交错排列(UF_LAYOUT_INTERLEAVED)，
+ * 把每个节点的父节点和权重放在同一个8字节的结构体中，
+ * 联合操作访问的cache line数量因此减半。
+ * 代价是只读取父节点的搜索操作每条cache line只能装下一半的节点。
+ *
+ * 对象数量极大时，内存占用本身就成了瓶颈。
+ * 权重只在根节点上有意义，而根节点的data元素只是指向自身，并不携带信息，
+ * 因此可以把权重直接编码进根节点的data元素(UF_LAYOUT_ROOT_ENCODED):
+ * 子节点的data仍是父节点的序号(非负数)，根节点的data则是负数，
+ * 按节点数连接时存放节点数的相反数。
+ * 这样完全省去了权重数组，存储结构的内存占用减半。
+ *
+ * 按秩连接时，秩不会超过lgN，
+ * 所以也可以选择把秩存放在一个uint8_t数组中(UF_LAYOUT_BYTE_WEIGHT)，
+ * 权重数组的内存占用降为原来的四分之一。
+ *
+ * ###零初始化#
+ *
+ * 其他排列方式在创建存储时都要遍历整个数组，把每个元素设为自己的序号、把权重设为初值。
+ * 对象数量达到1e9时，这个初始化过程需要数秒，
+ * 而且会使数组的每一个内存页都被实际分配，即使大部分对象从未出现在输入中。
+ *
+ * 零初始化排列(UF_LAYOUT_ZERO_INIT)调整了data的编码，使全0的元素表示只有单个节点的树:
+ * 子节点存放父节点的序号加1，根节点存放初始权重减去当前权重。
+ * 这样存储可以直接由calloc分配，
+ * 对于大块内存，calloc从操作系统取得的是按需分配的全0页面，
+ * 创建存储的耗时与对象数量无关，从未被访问的对象也不占用物理内存。
+ * 代价是每次读写父节点都多一次加减法。
+ *
+ * ###扩容#
+ *
+ * 对象的总数事先未知时(例如Keyed-union-find算法)，可以用uf_grow_storage扩大已有的存储，
+ * 原有对象的连接关系保持不变，新增的对象都是只有单个节点的树。
+ * 零初始化排列的扩容只需realloc再把新增部分清零，最适合这种用法。
+ *
+ * ###使用方法#
+ *
+ * uf-engine.h中的UF_ENGINE_LIST列出了全部16种组合，
+ * 并为每种组合的每种排列方式生成了uf_<名称>_new_storage和uf_<名称>_is_new_connection两个函数，
+ * 例如uf_w_qunion_pc_h_is_new_connection就是完全内联的
+ * Weighted-quick-union-with-path-compression-by-halving算法，
+ * uf_w_qunion_pc_h_il_is_new_connection和uf_w_qunion_pc_h_neg_is_new_connection
+ * 则分别是它的交错排列版本和根节点编码版本，_z结尾的则是零初始化版本。
+ * 字节权重排列的组合单独列在UF_BYTE_WEIGHT_ENGINE_LIST中，名称以_u8结尾。
+ *
+ * 调用者也可以直接调用uf_is_new_connection，并将策略和排列方式作为常量传入，
+ * 传入的排列方式必须与创建存储时选择的排列方式一致。
+ *
+ * @{
+ ****************************************/
+
+struct uf_storage *uf_new_storage(size_t object_num, enum uf_link_policy link, enum uf_layout layout) {
+    if (layout == UF_LAYOUT_BYTE_WEIGHT && link != UF_LINK_HEIGHT && link != UF_LINK_RANK) return NULL;
+
+    struct uf_storage *storage = malloc(sizeof(*storage));
+    if (storage == NULL) return NULL;
+
+    storage->object_num = object_num;
+    storage->link = link;
+    storage->layout = layout;
+    storage->data = NULL;
+    storage->weight = NULL;
+    storage->nodes = NULL;
+    storage->byte_weight = NULL;
+
+    int initial_weight = uf_initial_weight(link);
+
+    switch (layout) {
+    case UF_LAYOUT_SPLIT:
+        storage->data = malloc(sizeof(*storage->data) * object_num);
+        if (link != UF_LINK_NONE) storage->weight = malloc(sizeof(*storage->weight) * object_num);
+        if (storage->data == NULL || (link != UF_LINK_NONE && storage->weight == NULL)) break;
+        for (size_t i = 0; i < object_num; i++) storage->data[i] = i;
+        if (storage->weight != NULL) {
+            for (size_t i = 0; i < object_num; i++) storage->weight[i] = initial_weight;
+        }
+        return storage;
+    case UF_LAYOUT_INTERLEAVED:
+        storage->nodes = malloc(sizeof(*storage->nodes) * object_num);
+        if (storage->nodes == NULL) break;
+        for (size_t i = 0; i < object_num; i++) {
+            storage->nodes[i].parent = i;
+            storage->nodes[i].weight = initial_weight;
+        }
+        return storage;
+    case UF_LAYOUT_ROOT_ENCODED:
+        storage->data = malloc(sizeof(*storage->data) * object_num);
+        if (storage->data == NULL) break;
+        for (size_t i = 0; i < object_num; i++) storage->data[i] = -1;
+        return storage;
+    case UF_LAYOUT_BYTE_WEIGHT:
+        storage->data = malloc(sizeof(*storage->data) * object_num);
+        storage->byte_weight = malloc(sizeof(*storage->byte_weight) * object_num);
+        if (storage->data == NULL || storage->byte_weight == NULL) break;
+        for (size_t i = 0; i < object_num; i++) {
+            storage->data[i] = i;
+            storage->byte_weight[i] = 0;
+        }
+        return storage;
+    case UF_LAYOUT_ZERO_INIT:
+        storage->data = calloc(object_num, sizeof(*storage->data));
+        if (storage->data == NULL) break;
+        return storage;
+    }
+
+    uf_delete_storage(storage);
+    return NULL;
+}
+
+/**
+ * @brief 将存储扩大到object_num个对象，成功时返回true。
+ *
+ * 失败时存储保持原样，仍可继续使用。object_num不大于现有对象数时不做任何事。
+ */
+bool uf_grow_storage(struct uf_storage *storage, size_t object_num) {
+    size_t old_num = storage->object_num;
+    if (object_num <= old_num) return true;
+
+    int initial_weight = uf_initial_weight(storage->link);
+    void *grown;
+
+    switch (storage->layout) {
+    case UF_LAYOUT_SPLIT:
+        if (storage->weight != NULL) {
+            grown = realloc(storage->weight, sizeof(*storage->weight) * object_num);
+            if (grown == NULL) return false;
+            storage->weight = grown;
+            for (size_t i = old_num; i < object_num; i++) storage->weight[i] = initial_weight;
+        }
+        grown = realloc(storage->data, sizeof(*storage->data) * object_num);
+        if (grown == NULL) return false;
+        storage->data = grown;
+        for (size_t i = old_num; i < object_num; i++) storage->data[i] = i;
+        break;
+    case UF_LAYOUT_INTERLEAVED:
+        grown = realloc(storage->nodes, sizeof(*storage->nodes) * object_num);
+        if (grown == NULL) return false;
+        storage->nodes = grown;
+        for (size_t i = old_num; i < object_num; i++) {
+            storage->nodes[i].parent = i;
+            storage->nodes[i].weight = initial_weight;
+        }
+        break;
+    case UF_LAYOUT_ROOT_ENCODED:
+        grown = realloc(storage->data, sizeof(*storage->data) * object_num);
+        if (grown == NULL) return false;
+        storage->data = grown;
+        for (size_t i = old_num; i < object_num; i++) storage->data[i] = -1;
+        break;
+    case UF_LAYOUT_BYTE_WEIGHT:
+        grown = realloc(storage->byte_weight, sizeof(*storage->byte_weight) * object_num);
+        if (grown == NULL) return false;
+        storage->byte_weight = grown;
+        memset(storage->byte_weight + old_num, 0, sizeof(*storage->byte_weight) * (object_num - old_num));
+        grown = realloc(storage->data, sizeof(*storage->data) * object_num);
+        if (grown == NULL) return false;
+        storage->data = grown;
+        for (size_t i = old_num; i < object_num; i++) storage->data[i] = i;
+        break;
+    case UF_LAYOUT_ZERO_INIT:
+        grown = realloc(storage->data, sizeof(*storage->data) * object_num);
+        if (grown == NULL) return false;
+        storage->data = grown;
+        memset(storage->data + old_num, 0, sizeof(*storage->data) * (object_num - old_num));
+        break;
+    }
+
+    storage->object_num = object_num;
+    return true;
+}
+
+void uf_delete_storage(struct uf_storage *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage->weight);
+        free(storage->nodes);
+        free(storage->byte_weight);
+        free(storage);
+    }
+    return;
+}
+
+/****************************************
+ * @} -- UnionFindEngine
+ ****************************************/
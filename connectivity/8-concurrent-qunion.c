@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "connectivity.h"
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup ConcurrentQuickUnion
+ * @brief 连接问题算法8: Concurrent-quick-union算法。
+ *
+ * ###改进#
+ *
+ * 前面的所有算法都假定同一时刻只有一个线程访问存储数组。
+ * 在多核机器上，这意味着只有一个核在处理输入对，其余的核都在空转。
+ *
+ * 本算法允许任意多个线程同时对同一个存储数组调用is_new_connection和connected，
+ * 并且不使用任何锁，所有修改都通过原子的比较并交换(compare-and-swap, CAS)完成。
+ *
+ * ###数据结构#
+ *
+ * 与Quick-union算法相同，只是数组元素都是原子变量。
+ * 本算法不记录树的节点数或高度，原因见下文的连接规则。
+ *
+ * ###算法描述#
+ *
+ * -# 搜索操作
+ *
+ *    与Weighted-quick-union-with-path-compression-by-halving算法相同，
+ *    在追溯根节点的过程中把当前节点连接到其祖父节点上。
+ *    不同之处在于修改父节点时使用CAS:
+ *    只有当前节点的父节点仍是之前读到的值时，才将其改为祖父节点，
+ *    如果其他线程已经修改过该节点，则放弃本次压缩，继续向上追溯。
+ *    压缩只会把节点连接到它的祖先上，因此无论CAS成功与否，追溯的结果都是正确的。
+ *
+ * -# 联合操作
+ *
+ *    加权联合需要同时读写两个根节点的父节点和节点数，无法用一次CAS完成。
+ *    本算法改为按优先级连接: 每个对象有一个固定的优先级，
+ *    联合时总是将优先级较低的根节点连接到优先级较高的根节点下。
+ *
+ *    由于父节点的优先级总是高于子节点，沿着任何路径向上优先级严格递增，
+ *    所以无论多个线程如何交错执行，存储数组中都不可能出现闭环结构。
+ *
+ *    联合操作通过CAS把较低优先级根节点的父节点从自身改为另一个根节点。
+ *    CAS失败说明该节点已被其他线程连接到别的树下，不再是根节点，
+ *    此时重新追溯两个对象的根节点再试。
+ *    CAS成功时，较低优先级的根节点在连接的一刻仍是根节点，
+ *    而另一个树中的任何节点的优先级都不低于该根节点，不可能已经被连接到该根节点之下，
+ *    因此每次CAS成功都对应一次真正的集合合并，且每次合并只会有一个线程报告新连接。
+ *
+ *    如果直接使用对象的序号作为优先级，顺序输入(例如1-2, 2-3, 3-4 ...)会像Quick-union算法的最坏情况一样形成一条长链。
+ *    本算法用一个32位整数上的双射哈希函数打乱序号得到优先级，
+ *    相当于为每个对象随机分配了一个互不相同的优先级，这就是随机连接(randomized linking)，
+ *    其期望效果与按秩连接相当。
+ *
+ * -# connected操作
+ *
+ *    分别追溯两个对象的根节点，根节点相同则已连接。
+ *    根节点不同时，两者仍可能在追溯过程中被其他线程合并，
+ *    因此需要确认前一个根节点仍是根节点，才能判断两个对象未连接，否则重试。
+ *
+ *    c_qunion_find和c_qunion_connected在追溯时仍会尝试CAS压缩路径，
+ *    c_qunion_find_readonly和c_qunion_connected_readonly只读取存储数组，
+ *    以查询为主时，它们不会使其他核上的cache line失效。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+static int c_qunion_find_operation(struct concurrent_storage *storage, int p);
+static void c_qunion_union_operation(struct concurrent_storage *storage, int *proot, int *qroot);
+
+/**
+ * @brief 对象的优先级。
+ *
+ * 使用MurmurHash3的最终混合函数，它是32位整数上的双射，
+ * 因此不同对象的优先级必然不同。
+ */
+static inline uint32_t c_qunion_priority(int i) {
+    uint32_t h = (uint32_t)i;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+struct concurrent_storage *c_qunion_new_storage(size_t object_num) {
+    _Atomic int *data = malloc(sizeof(*data) * object_num);
+    if (data == NULL) return NULL;
+    for (size_t i = 0; i < object_num; i++) atomic_init(&data[i], i);
+
+    struct concurrent_storage *storage = malloc(sizeof(*storage));
+    if (storage == NULL) {
+        free(data);
+        return NULL;
+    }
+    storage->data = data;
+    storage->object_num = object_num;
+    return storage;
+}
+
+void c_qunion_delete_storage(struct concurrent_storage *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage);
+    }
+    return;
+}
+
+bool c_qunion_is_new_connection(struct concurrent_storage *storage, int p, int q) {
+    int proot, qroot, expected;
+    for (;;) {
+        proot = c_qunion_find_operation(storage, p);
+        qroot = c_qunion_find_operation(storage, q);
+        if (proot == qroot) return false;
+        c_qunion_union_operation(storage, &proot, &qroot);
+        expected = proot;
+        if (atomic_compare_exchange_strong(&storage->data[proot], &expected, qroot)) {
+            CONNECTIVITY_STATS_UNION(0);
+            return true;
+        }
+    }
+}
+
+bool c_qunion_connected(struct concurrent_storage *storage, int p, int q) {
+    int proot, qroot;
+    for (;;) {
+        proot = c_qunion_find_operation(storage, p);
+        qroot = c_qunion_find_operation(storage, q);
+        if (proot == qroot) return true;
+        if (atomic_load(&storage->data[proot]) == proot) return false;
+    }
+}
+
+/**
+ * @brief 返回p当前所在树的根节点，并尝试压缩追溯经过的路径。
+ *
+ * 有其他线程同时进行联合时，返回值在返回时可能已经不是根节点。
+ */
+int c_qunion_find(struct concurrent_storage *storage, int p) {
+    return c_qunion_find_operation(storage, p);
+}
+
+/**
+ * @brief 不压缩路径的find，只读取存储数组。
+ */
+int c_qunion_find_readonly(struct concurrent_storage *storage, int p) {
+    int i = p, parent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    while ((parent = atomic_load_explicit(&storage->data[i], memory_order_acquire)) != i) {
+        i = parent;
+        CONNECTIVITY_STATS_HOP();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 不压缩路径的connected，只读取存储数组。
+ */
+bool c_qunion_connected_readonly(struct concurrent_storage *storage, int p, int q) {
+    int proot, qroot;
+    for (;;) {
+        proot = c_qunion_find_readonly(storage, p);
+        qroot = c_qunion_find_readonly(storage, q);
+        if (proot == qroot) return true;
+        if (atomic_load(&storage->data[proot]) == proot) return false;
+    }
+}
+
+static int c_qunion_find_operation(struct concurrent_storage *storage, int p) {
+    int i = p, parent, grandparent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    for (;;) {
+        parent = atomic_load_explicit(&storage->data[i], memory_order_acquire);
+        if (parent == i) {
+            CONNECTIVITY_STATS_FIND_END();
+            return i;
+        }
+        grandparent = atomic_load_explicit(&storage->data[parent], memory_order_acquire);
+        if (grandparent != parent) {
+            if (atomic_compare_exchange_weak_explicit(&storage->data[i], &parent, grandparent,
+                                                      memory_order_release, memory_order_relaxed)) {
+                CONNECTIVITY_STATS_COMPRESSION_WRITE();
+            }
+        }
+        i = grandparent;
+        CONNECTIVITY_STATS_HOP();
+    }
+}
+
+/**
+ * @brief 联合操作的准备: 交换两个根节点，使*proot为优先级较低的一方。
+ *
+ * 真正的连接由调用者通过CAS完成。
+ */
+static void c_qunion_union_operation(struct concurrent_storage *storage, int *proot, int *qroot) {
+    if (c_qunion_priority(*proot) > c_qunion_priority(*qroot)) {
+        int tmp = *proot;
+        *proot = *qroot;
+        *qroot = tmp;
+    }
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- ConcurrentQuickUnion
+ ****************************************/
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "connectivity.h"
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup Connectivity
+ * @defgroup WeightedQuickUnion64
+ * @brief 连接问题算法9: 64位序号的Weighted-quick-union算法。
+ *
+ * ###改进#
+ *
+ * 前面的算法都用int表示对象的序号、父节点和树的节点数，
+ * 对象的数量因此不能超过INT_MAX(约2.1e9)。
+ *
+ * 本算法把序号扩展到64位，同时提供两种存储格式:
+ * - 宽格式(STORAGE_64_WIDE): 每个对象占用一个int64_t。
+ * - 40位紧凑格式(STORAGE_64_PACKED40): 每个对象只占用5个字节，
+ *   可以容纳2^39(约5.5e11)个对象。
+ *
+ * ###数据结构#
+ *
+ * 如果照搬Weighted-quick-union算法的做法，另外用一个数组存放树的节点数，
+ * 64位序号会使存储结构的内存占用翻倍。
+ * 因此本算法采用与通用引擎的UF_LAYOUT_ROOT_ENCODED相同的编码:
+ * 子节点的元素存放父节点的序号(非负数)，根节点的元素存放树的节点数的相反数(负数)，
+ * 不再需要单独的节点数数组。
+ *
+ * 这样，宽格式的内存占用与int版本的Weighted-quick-union算法相同(8字节/对象)，
+ * 紧凑格式则比int版本还少3/8。
+ *
+ * 紧凑格式的每个元素是一个40位的有符号整数，按小端顺序存放在连续的5个字节中，
+ * 存取时需要拼接和拆分字节，比宽格式多一些计算，但内存访问量更少。
+ *
+ * ###算法描述#
+ *
+ * w_qunion_64与Weighted-quick-union算法相同，
+ * w_qunion_pc_h_64与Weighted-quick-union-with-path-compression-by-halving算法相同，
+ * 两者共用同一种存储结构。
+ * 查询操作也与对应的int版本相同，w_qunion_pc_h_64另有不压缩路径的*_readonly版本。
+ *
+ * @{
+ ****************************************/
+
+#ifndef DOC_COMPILE
+
+static void w_qunion_64_find_operation(struct storage_64 *storage, int64_t p, int64_t q, int64_t *proot, int64_t *qroot, bool halving);
+static void w_qunion_64_union_operation(struct storage_64 *storage, int64_t proot, int64_t qroot);
+
+/**
+ * @brief 紧凑格式下每个元素占用的字节数。
+ */
+#define PACKED40_WIDTH 5
+
+static inline int64_t packed40_get(const unsigned char *packed, int64_t i) {
+    const unsigned char *b = packed + i * PACKED40_WIDTH;
+    uint64_t v = (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16 | (uint64_t)b[3] << 24 | (uint64_t)b[4] << 32;
+    // 将第39位符号位扩展到64位
+    return (int64_t)(v << 24) >> 24;
+}
+
+static inline void packed40_set(unsigned char *packed, int64_t i, int64_t value) {
+    unsigned char *b = packed + i * PACKED40_WIDTH;
+    uint64_t v = (uint64_t)value;
+    b[0] = v;
+    b[1] = v >> 8;
+    b[2] = v >> 16;
+    b[3] = v >> 24;
+    b[4] = v >> 32;
+    return;
+}
+
+static inline int64_t storage_64_get(struct storage_64 *storage, int64_t i) {
+    return storage->layout == STORAGE_64_PACKED40 ? packed40_get(storage->packed, i) : storage->data[i];
+}
+
+static inline void storage_64_set(struct storage_64 *storage, int64_t i, int64_t value) {
+    if (storage->layout == STORAGE_64_PACKED40) packed40_set(storage->packed, i, value);
+    else storage->data[i] = value;
+    return;
+}
+
+static struct storage_64 *storage_64_new(int64_t object_num, enum storage_64_layout layout) {
+    if (object_num < 0) return NULL;
+    if (layout == STORAGE_64_PACKED40 && object_num > ((int64_t)1 << 39) - 1) return NULL;
+
+    struct storage_64 *storage = malloc(sizeof(*storage));
+    if (storage == NULL) return NULL;
+    storage->object_num = object_num;
+    storage->layout = layout;
+    storage->data = NULL;
+    storage->packed = NULL;
+
+    if (layout == STORAGE_64_PACKED40) {
+        storage->packed = malloc((size_t)object_num * PACKED40_WIDTH);
+        if (storage->packed == NULL) {
+            free(storage);
+            return NULL;
+        }
+        // 根节点的元素为-1，即节点数为1；-1的每个字节都是0xff
+        memset(storage->packed, 0xff, (size_t)object_num * PACKED40_WIDTH);
+    } else {
+        storage->data = malloc(sizeof(*storage->data) * (size_t)object_num);
+        if (storage->data == NULL) {
+            free(storage);
+            return NULL;
+        }
+        for (int64_t i = 0; i < object_num; i++) storage->data[i] = -1;
+    }
+    return storage;
+}
+
+static void storage_64_delete(struct storage_64 *storage) {
+    if (storage != NULL) {
+        free(storage->data);
+        free(storage->packed);
+        free(storage);
+    }
+    return;
+}
+
+struct storage_64 *w_qunion_64_new_storage(int64_t object_num, enum storage_64_layout layout) {
+    return storage_64_new(object_num, layout);
+}
+
+void w_qunion_64_delete_storage(struct storage_64 *storage) {
+    storage_64_delete(storage);
+    return;
+}
+
+bool w_qunion_64_is_new_connection(struct storage_64 *storage, int64_t p, int64_t q) {
+    int64_t proot, qroot;
+    w_qunion_64_find_operation(storage, p, q, &proot, &qroot, false);
+    if (proot == qroot) return false;
+    w_qunion_64_union_operation(storage, proot, qroot);
+    return true;
+}
+
+struct storage_64 *w_qunion_pc_h_64_new_storage(int64_t object_num, enum storage_64_layout layout) {
+    return storage_64_new(object_num, layout);
+}
+
+void w_qunion_pc_h_64_delete_storage(struct storage_64 *storage) {
+    storage_64_delete(storage);
+    return;
+}
+
+bool w_qunion_pc_h_64_is_new_connection(struct storage_64 *storage, int64_t p, int64_t q) {
+    int64_t proot, qroot;
+    w_qunion_64_find_operation(storage, p, q, &proot, &qroot, true);
+    if (proot == qroot) return false;
+    w_qunion_64_union_operation(storage, proot, qroot);
+    return true;
+}
+
+static inline int64_t w_qunion_64_find_root(struct storage_64 *storage, int64_t p, bool halving) {
+    int64_t i, parent, grandparent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+    if (!halving) {
+        for (i = p; (parent = storage_64_get(storage, i)) >= 0; i = parent) CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_FIND_END();
+        return i;
+    }
+    for (i = p; (parent = storage_64_get(storage, i)) >= 0; i = grandparent) {
+        CONNECTIVITY_STATS_HOP();
+        grandparent = storage_64_get(storage, parent);
+        if (grandparent < 0) {
+            CONNECTIVITY_STATS_FIND_END();
+            return parent;
+        }
+        storage_64_set(storage, i, grandparent);
+        CONNECTIVITY_STATS_COMPRESSION_WRITE();
+    }
+    CONNECTIVITY_STATS_FIND_END();
+    return i;
+}
+
+/**
+ * @brief 返回p所在树的根节点，不修改存储结构。
+ */
+int64_t w_qunion_64_find(const struct storage_64 *storage, int64_t p) {
+    // 不压缩路径时只读取存储结构
+    return w_qunion_64_find_root((struct storage_64 *)storage, p, false);
+}
+
+bool w_qunion_64_connected(const struct storage_64 *storage, int64_t p, int64_t q) {
+    return w_qunion_64_find(storage, p) == w_qunion_64_find(storage, q);
+}
+
+/**
+ * @brief 返回p所在树的根节点，并以路径减半的方式压缩追溯经过的路径。
+ */
+int64_t w_qunion_pc_h_64_find(struct storage_64 *storage, int64_t p) {
+    return w_qunion_64_find_root(storage, p, true);
+}
+
+bool w_qunion_pc_h_64_connected(struct storage_64 *storage, int64_t p, int64_t q) {
+    return w_qunion_pc_h_64_find(storage, p) == w_qunion_pc_h_64_find(storage, q);
+}
+
+int64_t w_qunion_pc_h_64_find_readonly(const struct storage_64 *storage, int64_t p) {
+    return w_qunion_64_find(storage, p);
+}
+
+bool w_qunion_pc_h_64_connected_readonly(const struct storage_64 *storage, int64_t p, int64_t q) {
+    return w_qunion_64_connected(storage, p, q);
+}
+
+static void w_qunion_64_find_operation(struct storage_64 *storage, int64_t p, int64_t q, int64_t *proot, int64_t *qroot, bool halving) {
+    *proot = w_qunion_64_find_root(storage, p, halving);
+    *qroot = w_qunion_64_find_root(storage, q, halving);
+    return;
+}
+
+static void w_qunion_64_union_operation(struct storage_64 *storage, int64_t proot, int64_t qroot) {
+    // 根节点的元素是节点数的相反数
+    int64_t psize = -storage_64_get(storage, proot);
+    int64_t qsize = -storage_64_get(storage, qroot);
+    CONNECTIVITY_STATS_UNION(psize < qsize ? psize : qsize);
+    if (psize < qsize) {
+        storage_64_set(storage, proot, qroot);
+        storage_64_set(storage, qroot, -(psize + qsize));
+    } else {
+        storage_64_set(storage, qroot, proot);
+        storage_64_set(storage, proot, -(psize + qsize));
+    }
+    return;
+}
+
+#endif // #ifndef DOC_COMPILE
+
+/****************************************
+ * @} -- WeightedQuickUnion64
+ ****************************************/
@@ -0,0 +1,549 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include "connectivity.h"
+#include "uf-engine.h"
+#include "random-pairs.h"
+#include "workloads.h"
+#include "perf-counters.h"
+#include "latency-histogram.h"
+
+/****************************************
+ * connectivity-bench: 连接问题各算法的基准测试程序。
+ *
+ * testcase-speed.c中的速度测试用clock()对每个算法只计时一次，
+ * 而且受Check测试用例超时的限制，大规模下Quick-find和Quick-union算法的结果会直接丢失。
+ *
+ * 本程序对每一种(算法, 规模, 输入形态)组合:
+ * - 先进行若干次预热，再进行若干次正式测试，每次都使用新建的存储结构，
+ *   计时只包括处理输入对的过程，使用单调时钟。
+ * - 报告最短耗时、中位数、第95百分位数，以及按中位数计算的每个输入对的纳秒数和每秒处理的输入对个数。
+ * - 单次测试超过时间上限时立即停止，该组合的状态记为timeout，
+ *   其耗时按已处理的输入对计算，而不是丢弃结果。
+ * - 结果以CSV或JSON格式输出到标准输出，进度信息输出到标准错误，便于比较不同版本的结果。
+ * - 指定-p时，用perf_event_open在计时的范围内统计周期、指令、L1D/LLC/dTLB缺失和分支预测失败，
+ *   报告正式测试中平均每个输入对的计数。内核不允许或硬件不支持的事件输出为空值，不影响计时。
+ * - 吞吐量掩盖了尾部延迟，例如Quick-union算法偶尔的长路径、Quick-find算法每次O(N)的联合。
+ *   正式测试之后再进行一次延迟测试，单独计时每一次is_new_connection，
+ *   记入对数分桶的直方图(见latency-histogram.h)，报告p50、p99、p99.9和最大值。
+ *   计时在x86上使用时间戳计数器，每次调用只增加约两次rdtsc的开销。指定-L时跳过延迟测试。
+ ****************************************/
+
+/**
+ * @brief 检查时间上限的间隔(以输入对为单位)。
+ *
+ * 间隔从BENCH_MIN_CHUNK_PAIRS开始每次加倍，直到BENCH_CHUNK_PAIRS，
+ * 但不超过按上一段的速度估计、在BENCH_CHUNK_SECONDS和剩余时间的一半中较小者内
+ * 能处理的输入对个数(至少为1)。
+ * 这样每个输入对需要O(N)时间的算法，以及越来越慢的算法(例如Quick-union算法的树越来越高)
+ * 也能在时间上限附近停止，而快的算法检查时钟的开销仍可以忽略。
+ */
+#define BENCH_MIN_CHUNK_PAIRS 64
+#define BENCH_CHUNK_PAIRS 65536
+#define BENCH_CHUNK_SECONDS 0.01
+
+#define BENCH_MAX_TRIALS 1000
+
+/**
+ * @brief 一种被测算法。run处理一段输入对，返回其中新连接的个数。
+ *
+ * latency与run相同，但单独计时每一个输入对，记入histogram。
+ */
+struct bench_engine {
+    const char *name;
+    void *(*new_storage)(size_t object_num);
+    void (*delete_storage)(void *storage);
+    size_t (*run)(void *storage, size_t object_num, int (*pairs)[2], size_t pair_num);
+    size_t (*latency)(void *storage, size_t object_num, int (*pairs)[2], size_t pair_num, struct latency_histogram *histogram);
+};
+
+/**
+ * @brief 为一种算法生成new、delete、run、latency四个函数。
+ *
+ * is_new_connection中可以使用s(类型为type的存储)、object_num以及当前输入对的p、q。
+ */
+#define BENCH_DEFINE_ENGINE(name, type, new_storage_call, delete_storage_call, is_new_connection) \
+    static void *bench_new_##name(size_t object_num) { \
+        return new_storage_call; \
+    } \
+    static void bench_delete_##name(void *storage) { \
+        type s = storage; \
+        delete_storage_call; \
+    } \
+    static size_t bench_run_##name(void *storage, size_t object_num, int (*pairs)[2], size_t pair_num) { \
+        type s = storage; \
+        size_t new_num = 0; \
+        for (size_t i = 0; i < pair_num; i++) { \
+            int p = pairs[i][0], q = pairs[i][1]; \
+            new_num += is_new_connection; \
+        } \
+        return new_num; \
+    } \
+    static size_t bench_latency_##name(void *storage, size_t object_num, int (*pairs)[2], size_t pair_num, \
+                                       struct latency_histogram *histogram) { \
+        type s = storage; \
+        size_t new_num = 0; \
+        for (size_t i = 0; i < pair_num; i++) { \
+            int p = pairs[i][0], q = pairs[i][1]; \
+            uint64_t start_tick = latency_now(); \
+            new_num += is_new_connection; \
+            latency_record(histogram, latency_now() - start_tick); \
+        } \
+        return new_num; \
+    }
+
+// Keyed-quick-union算法的键由序号打散得到，与测试用例相同
+#define BENCH_KEY(i) ((uint64_t)(i) * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL)
+
+BENCH_DEFINE_ENGINE(qfind, int *, qfind_new_storage(object_num), qfind_delete_storage(s),
+                    qfind_is_new_connection(s, object_num, p, q))
+BENCH_DEFINE_ENGINE(qunion, int *, qunion_new_storage(object_num), qunion_delete_storage(s),
+                    qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(w_qunion, struct storage_with_tree_size *, w_qunion_new_storage(object_num), w_qunion_delete_storage(s),
+                    w_qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(w_qunion_pc, struct storage_with_tree_size *, w_qunion_pc_new_storage(object_num), w_qunion_pc_delete_storage(s),
+                    w_qunion_pc_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(w_qunion_pc_h, struct storage_with_tree_size *, w_qunion_pc_h_new_storage(object_num), w_qunion_pc_h_delete_storage(s),
+                    w_qunion_pc_h_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(h_qunion, struct storage_with_tree_height *, h_qunion_new_storage(object_num), h_qunion_delete_storage(s),
+                    h_qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(c_qunion, struct concurrent_storage *, c_qunion_new_storage(object_num), c_qunion_delete_storage(s),
+                    c_qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(w_qunion_pc_h_64, struct storage_64 *, w_qunion_pc_h_64_new_storage(object_num, STORAGE_64_WIDE),
+                    w_qunion_pc_h_64_delete_storage(s), w_qunion_pc_h_64_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(w_qunion_pc_h_64_packed, struct storage_64 *, w_qunion_pc_h_64_new_storage(object_num, STORAGE_64_PACKED40),
+                    w_qunion_pc_h_64_delete_storage(s), w_qunion_pc_h_64_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(rb_qunion, struct rollback_storage *, rb_qunion_new_storage(object_num), rb_qunion_delete_storage(s),
+                    rb_qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(vr_qunion, struct versioned_storage *, vr_qunion_new_storage(object_num), vr_qunion_delete_storage(s),
+                    vr_qunion_is_new_connection(s, p, q))
+BENCH_DEFINE_ENGINE(k_qunion, struct keyed_storage *, k_qunion_new_storage(object_num), k_qunion_delete_storage(s),
+                    k_qunion_is_new_connection(s, BENCH_KEY(p), BENCH_KEY(q)))
+
+// 批量处理的版本一次处理整段输入对
+static size_t bench_run_w_qunion_pc_h_batch(void *storage, size_t object_num, int (*pairs)[2], size_t pair_num) {
+    unsigned char bitmap[BENCH_CHUNK_PAIRS / 8];
+    size_t new_num = 0;
+    w_qunion_pc_h_process_batch(storage, pairs, pair_num, bitmap);
+    for (size_t i = 0; i < (pair_num + 7) / 8; i++) new_num += __builtin_popcount(bitmap[i]);
+    return new_num;
+}
+
+#define BENCH_DEFINE_UF_ENGINE(name, link, compress, layout) \
+    BENCH_DEFINE_ENGINE(uf_##name, struct uf_storage *, uf_##name##_new_storage(object_num), uf_delete_storage(s), \
+                        uf_##name##_is_new_connection(s, p, q))
+#define BENCH_DEFINE_UF_ENGINE_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(BENCH_DEFINE_UF_ENGINE, name, link, compress)
+
+UF_ENGINE_LIST(BENCH_DEFINE_UF_ENGINE_LAYOUTS)
+UF_BYTE_WEIGHT_ENGINE_LIST(BENCH_DEFINE_UF_ENGINE)
+
+#define BENCH_ENGINE_ENTRY(name) {#name, bench_new_##name, bench_delete_##name, bench_run_##name, bench_latency_##name},
+#define BENCH_UF_ENGINE_ENTRY(name, link, compress, layout) BENCH_ENGINE_ENTRY(uf_##name)
+#define BENCH_UF_ENGINE_ENTRY_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(BENCH_UF_ENGINE_ENTRY, name, link, compress)
+
+static const struct bench_engine g_bench_engines[] = {
+    BENCH_ENGINE_ENTRY(qfind)
+    BENCH_ENGINE_ENTRY(qunion)
+    BENCH_ENGINE_ENTRY(w_qunion)
+    BENCH_ENGINE_ENTRY(w_qunion_pc)
+    BENCH_ENGINE_ENTRY(w_qunion_pc_h)
+    // 批量处理没有单次调用的延迟，延迟测试使用逐个处理的版本
+    {"w_qunion_pc_h_batch", bench_new_w_qunion_pc_h, bench_delete_w_qunion_pc_h, bench_run_w_qunion_pc_h_batch,
+     bench_latency_w_qunion_pc_h},
+    BENCH_ENGINE_ENTRY(h_qunion)
+    BENCH_ENGINE_ENTRY(c_qunion)
+    BENCH_ENGINE_ENTRY(w_qunion_pc_h_64)
+    BENCH_ENGINE_ENTRY(w_qunion_pc_h_64_packed)
+    BENCH_ENGINE_ENTRY(k_qunion)
+    BENCH_ENGINE_ENTRY(rb_qunion)
+    BENCH_ENGINE_ENTRY(vr_qunion)
+    UF_ENGINE_LIST(BENCH_UF_ENGINE_ENTRY_LAYOUTS)
+    UF_BYTE_WEIGHT_ENGINE_LIST(BENCH_UF_ENGINE_ENTRY)
+};
+
+#define BENCH_ENGINE_NUM (sizeof(g_bench_engines) / sizeof(g_bench_engines[0]))
+
+/**
+ * @brief 测试规模，与testcase-speed.c中的规模相同。
+ */
+struct bench_scale {
+    const char *name;
+    int object_num, pair_num;
+};
+
+static const struct bench_scale g_bench_scales[] = {
+    {"tiny", 1e3, 5e3},
+    {"small", 1e4, 5e4},
+    {"medium", 1e5, 5e5},
+    {"large", 1e6, 5e6},
+    {"massive", 1e7, 5e7}
+};
+
+#define BENCH_SCALE_NUM (sizeof(g_bench_scales) / sizeof(g_bench_scales[0]))
+
+struct bench_options {
+    char *engines, *workloads, *scales;
+    int trial_num, warmup_num;
+    double time_limit;
+    uint64_t seed;
+    bool json;
+    bool latency;
+    // 不统计硬件事件时为NULL
+    struct perf_counters *counters;
+};
+
+/**
+ * @brief 一种组合的测试结果，耗时以秒为单位。
+ */
+struct bench_result {
+    const char *status;
+    int trial_num;
+    size_t processed_num, new_num;
+    double min, median, p95;
+    // 各硬件事件在counted_num个输入对上的计数之和
+    uint64_t counter_sums[PERF_COUNTER_NUM];
+    size_t counted_num;
+    // 延迟测试的结果(纳秒)，latency_num为计时的调用次数
+    size_t latency_num;
+    double latency_p50, latency_p99, latency_p999, latency_max;
+};
+
+static double bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief 进行一次测试，返回耗时，存储创建失败时返回负数。
+ *
+ * 超过时间上限时提前停止，*processed_num为实际处理的输入对个数。
+ * counters不为NULL时，计数的范围与计时的范围相同。
+ * histogram不为NULL时为延迟测试，逐个计时每个输入对。
+ */
+static double bench_trial(const struct bench_engine *engine, const struct random_pairs *input, double time_limit,
+                          struct perf_counters *counters, struct latency_histogram *histogram,
+                          size_t *processed_num, size_t *new_num) {
+    void *storage = engine->new_storage(input->object_num);
+    if (storage == NULL) return -1;
+
+    size_t processed = 0, new_connections = 0, chunk_limit = BENCH_MIN_CHUNK_PAIRS;
+    if (counters != NULL) perf_counters_start(counters);
+    double start_time = bench_now(), elapsed = 0;
+    while (processed < (size_t)input->pair_num) {
+        size_t chunk = input->pair_num - processed < chunk_limit ? input->pair_num - processed : chunk_limit;
+        if (histogram != NULL) {
+            new_connections += engine->latency(storage, input->object_num, input->pairs + processed, chunk, histogram);
+        } else {
+            new_connections += engine->run(storage, input->object_num, input->pairs + processed, chunk);
+        }
+        processed += chunk;
+        double chunk_elapsed = bench_now() - start_time - elapsed;
+        elapsed += chunk_elapsed;
+        if (elapsed > time_limit) break;
+        if (chunk_limit < BENCH_CHUNK_PAIRS) chunk_limit *= 2;
+        double budget = (time_limit - elapsed) / 2 < BENCH_CHUNK_SECONDS ? (time_limit - elapsed) / 2 : BENCH_CHUNK_SECONDS;
+        double affordable = budget / (chunk_elapsed / chunk);
+        if (affordable < chunk_limit) chunk_limit = affordable >= 1 ? (size_t)affordable : 1;
+    }
+    if (counters != NULL) perf_counters_stop(counters);
+
+    engine->delete_storage(storage);
+    *processed_num = processed;
+    *new_num = new_connections;
+    return elapsed;
+}
+
+static int bench_compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_add_counters(struct bench_result *result, const struct perf_counters *counters, size_t processed_num) {
+    if (counters == NULL) return;
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) result->counter_sums[i] += counters->values[i];
+    result->counted_num += processed_num;
+    return;
+}
+
+/**
+ * @brief 延迟测试，与正式测试使用相同的时间上限。
+ */
+static void bench_latency(const struct bench_engine *engine, const struct random_pairs *input,
+                          const struct bench_options *options, struct bench_result *result) {
+    static struct latency_histogram histogram;
+    size_t processed_num, new_num;
+    double ticks_per_ns = latency_ticks_per_ns();
+
+    latency_histogram_reset(&histogram);
+    if (bench_trial(engine, input, options->time_limit, NULL, &histogram, &processed_num, &new_num) < 0) return;
+    result->latency_num = histogram.total;
+    result->latency_p50 = latency_percentile(&histogram, 0.5) / ticks_per_ns;
+    result->latency_p99 = latency_percentile(&histogram, 0.99) / ticks_per_ns;
+    result->latency_p999 = latency_percentile(&histogram, 0.999) / ticks_per_ns;
+    result->latency_max = histogram.max / ticks_per_ns;
+    return;
+}
+
+static struct bench_result bench_run(const struct bench_engine *engine, const struct random_pairs *input,
+                                     const struct bench_options *options) {
+    struct bench_result result = {.status = "ok"};
+    double times[BENCH_MAX_TRIALS];
+    size_t processed_num = 0, new_num = 0;
+
+    for (int i = 0; i < options->warmup_num + options->trial_num; i++) {
+        double elapsed = bench_trial(engine, input, options->time_limit, options->counters, NULL, &processed_num, &new_num);
+        if (elapsed < 0) {
+            result.status = "no_memory";
+            return result;
+        }
+        if (processed_num < (size_t)input->pair_num) {
+            // 超时的那一次作为唯一的结果，后面的测试不再进行
+            result.status = "timeout";
+            result.trial_num = 1;
+            result.processed_num = processed_num;
+            result.new_num = new_num;
+            result.min = result.median = result.p95 = elapsed;
+            bench_add_counters(&result, options->counters, processed_num);
+            // 超时的算法的尾部延迟正是需要了解的，仍然进行延迟测试
+            if (options->latency) bench_latency(engine, input, options, &result);
+            return result;
+        }
+        if (i >= options->warmup_num) {
+            times[result.trial_num++] = elapsed;
+            bench_add_counters(&result, options->counters, processed_num);
+        }
+    }
+
+    qsort(times, result.trial_num, sizeof(times[0]), bench_compare_double);
+    result.processed_num = input->pair_num;
+    result.new_num = new_num;
+    result.min = times[0];
+    result.median = result.trial_num % 2 ? times[result.trial_num / 2]
+                                         : (times[result.trial_num / 2 - 1] + times[result.trial_num / 2]) / 2;
+    // 按nearest-rank方法取第95百分位数
+    result.p95 = times[(result.trial_num * 95 + 99) / 100 - 1];
+    if (options->latency) bench_latency(engine, input, options, &result);
+    return result;
+}
+
+static bool g_bench_first_row = true;
+
+static void bench_print_header(const struct bench_options *options) {
+    if (options->json) {
+        printf("[\n");
+        return;
+    }
+    printf("engine,workload,scale,object_num,pair_num,status,trials,processed,new_connections,"
+           "min_s,median_s,p95_s,ns_per_op,ops_per_s");
+    if (options->latency) printf(",latency_calls,latency_p50_ns,latency_p99_ns,latency_p999_ns,latency_max_ns");
+    if (options->counters != NULL) {
+        for (int i = 0; i < PERF_COUNTER_NUM; i++) printf(",%s_per_op", perf_counter_name(i));
+    }
+    printf("\n");
+    return;
+}
+
+/**
+ * @brief 输出平均每个输入对的硬件事件计数，不可用的事件输出为空值。
+ */
+static void bench_print_counters(const struct bench_options *options, const struct bench_result *result) {
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        bool available = perf_counters_available(options->counters, i) && result->counted_num > 0;
+        double per_op = available ? (double)result->counter_sums[i] / result->counted_num : 0;
+        if (options->json) {
+            printf(", \"%s_per_op\": ", perf_counter_name(i));
+            if (available) printf("%.4f", per_op);
+            else printf("null");
+        } else {
+            printf(",");
+            if (available) printf("%.4f", per_op);
+        }
+    }
+    return;
+}
+
+static void bench_print_result(const struct bench_options *options, const char *engine, const char *workload,
+                               const struct bench_scale *scale, const struct bench_result *result) {
+    double ns_per_op = result->processed_num > 0 ? result->median * 1e9 / result->processed_num : 0;
+    double ops_per_s = result->median > 0 ? result->processed_num / result->median : 0;
+    if (options->json) {
+        printf("%s  {\"engine\": \"%s\", \"workload\": \"%s\", \"scale\": \"%s\", \"object_num\": %d, \"pair_num\": %d, "
+               "\"status\": \"%s\", \"trials\": %d, \"processed\": %zu, \"new_connections\": %zu, "
+               "\"min_s\": %.9f, \"median_s\": %.9f, \"p95_s\": %.9f, \"ns_per_op\": %.3f, \"ops_per_s\": %.1f",
+               g_bench_first_row ? "" : ",\n", engine, workload, scale->name, scale->object_num, scale->pair_num,
+               result->status, result->trial_num, result->processed_num, result->new_num,
+               result->min, result->median, result->p95, ns_per_op, ops_per_s);
+    } else {
+        printf("%s,%s,%s,%d,%d,%s,%d,%zu,%zu,%.9f,%.9f,%.9f,%.3f,%.1f",
+               engine, workload, scale->name, scale->object_num, scale->pair_num,
+               result->status, result->trial_num, result->processed_num, result->new_num,
+               result->min, result->median, result->p95, ns_per_op, ops_per_s);
+    }
+    if (options->latency) {
+        printf(options->json ? ", \"latency_calls\": %zu, \"latency_p50_ns\": %.1f, \"latency_p99_ns\": %.1f, "
+                               "\"latency_p999_ns\": %.1f, \"latency_max_ns\": %.1f"
+                             : ",%zu,%.1f,%.1f,%.1f,%.1f",
+               result->latency_num, result->latency_p50, result->latency_p99, result->latency_p999, result->latency_max);
+    }
+    if (options->counters != NULL) bench_print_counters(options, result);
+    printf(options->json ? "}" : "\n");
+    g_bench_first_row = false;
+    fflush(stdout);
+    return;
+}
+
+static void bench_print_footer(const struct bench_options *options) {
+    if (options->json) printf("%s]\n", g_bench_first_row ? "" : "\n");
+    return;
+}
+
+/**
+ * @brief 判断name是否在逗号分隔的列表list中，列表为"all"时总是成立。
+ */
+static bool bench_selected(const char *list, const char *name) {
+    if (strcmp(list, "all") == 0) return true;
+    size_t length = strlen(name);
+    for (const char *item = list; item != NULL; item = strchr(item, ',') ? strchr(item, ',') + 1 : NULL) {
+        if (strncmp(item, name, length) == 0 && (item[length] == ',' || item[length] == '\0')) return true;
+    }
+    return false;
+}
+
+static void bench_usage(const char *program) {
+    fprintf(stderr,
+            "syntax: %s [-e engines] [-w workloads] [-s scales] [-r trials] [-W warmups] [-t seconds] [-S seed] [-f csv|json] [-p] [-L]\n"
+            "       %s -l\n"
+            "  -e engines    comma-separated engine names or all, default all\n"
+            "  -w workloads  comma-separated workload names or all, default uniform\n"
+            "  -s scales     comma-separated scales (tiny,small,medium,large,massive) or all, default tiny,small,medium,large\n"
+            "  -r trials     measured trials per combination, default 5\n"
+            "  -W warmups    warmup trials per combination, default 1\n"
+            "  -t seconds    time limit of a single trial, default 10\n"
+            "  -S seed       seed of the generated pairs\n"
+            "  -f format     output format, csv (default) or json\n"
+            "  -p            count hardware events with perf_event_open\n"
+            "  -L            skip the per-call latency trial\n"
+            "  -l            list engines, workloads and scales\n",
+            program, program);
+    exit(EXIT_FAILURE);
+}
+
+static void bench_list(void) {
+    printf("engines:");
+    for (size_t i = 0; i < BENCH_ENGINE_NUM; i++) printf(" %s", g_bench_engines[i].name);
+    printf("\nworkloads:");
+    for (int i = 0; workload_name(i) != NULL; i++) printf(" %s", workload_name(i));
+    printf("\nscales:");
+    for (size_t i = 0; i < BENCH_SCALE_NUM; i++) printf(" %s", g_bench_scales[i].name);
+    printf("\n");
+    return;
+}
+
+static double bench_parse_number(const char *text, const char *name, double min, double max) {
+    char *str_end = NULL;
+    errno = 0;
+    double value = strtod(text, &str_end);
+    if (errno == ERANGE || str_end == text || str_end[0] != '\0' || value < min || value > max) {
+        fprintf(stderr, "%s out of range.\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+/**
+ * @brief 解析种子，不是完整的无符号整数(包括带负号)时返回false。
+ */
+static bool bench_parse_seed(const char *text, uint64_t *seed) {
+    char *str_end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &str_end, 0);
+    if (errno == ERANGE || str_end == text || str_end[0] != '\0' || strchr(text, '-') != NULL) return false;
+    *seed = value;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    struct bench_options options = {"all", "uniform", "tiny,small,medium,large", 5, 1, 10, RANDOM_PAIRS_DEFAULT_SEED, false, true, NULL};
+    struct perf_counters counters;
+    int option;
+
+    while ((option = getopt(argc, argv, "e:w:s:r:W:t:S:f:pLlh")) != -1) {
+        switch (option) {
+        case 'e':
+            options.engines = optarg;
+            break;
+        case 'w':
+            options.workloads = optarg;
+            break;
+        case 's':
+            options.scales = optarg;
+            break;
+        case 'r':
+            options.trial_num = bench_parse_number(optarg, "trials", 1, BENCH_MAX_TRIALS);
+            break;
+        case 'W':
+            options.warmup_num = bench_parse_number(optarg, "warmups", 0, BENCH_MAX_TRIALS);
+            break;
+        case 't':
+            options.time_limit = bench_parse_number(optarg, "time limit", 0, 1e9);
+            break;
+        case 'S':
+            if (!bench_parse_seed(optarg, &options.seed)) bench_usage(argv[0]);
+            break;
+        case 'f':
+            if (strcmp(optarg, "json") == 0) options.json = true;
+            else if (strcmp(optarg, "csv") == 0) options.json = false;
+            else bench_usage(argv[0]);
+            break;
+        case 'p':
+            options.counters = &counters;
+            break;
+        case 'L':
+            options.latency = false;
+            break;
+        case 'l':
+            bench_list();
+            return 0;
+        default:
+            bench_usage(argv[0]);
+        }
+    }
+    if (optind != argc) bench_usage(argv[0]);
+    if (options.counters != NULL && !perf_counters_open(options.counters)) {
+        // 计数器不可用时仍然输出对应的列，值为空，便于与其他机器上的结果合并
+        fprintf(stderr, "bench: hardware counters unavailable (%s), reporting timing only.\n", strerror(errno));
+    }
+
+    bench_print_header(&options);
+    for (int w = 0; workload_name(w) != NULL; w++) {
+        if (!bench_selected(options.workloads, workload_name(w))) continue;
+        for (size_t s = 0; s < BENCH_SCALE_NUM; s++) {
+            const struct bench_scale *scale = &g_bench_scales[s];
+            if (!bench_selected(options.scales, scale->name)) continue;
+
+            struct random_pairs *input = workload_pairs_new(workload_name(w), scale->object_num, scale->pair_num, options.seed);
+            if (input == NULL) {
+                fprintf(stderr, "fail to generate %s pairs in %s scale.\n", workload_name(w), scale->name);
+                exit(EXIT_FAILURE);
+            }
+            for (size_t e = 0; e < BENCH_ENGINE_NUM; e++) {
+                const struct bench_engine *engine = &g_bench_engines[e];
+                if (!bench_selected(options.engines, engine->name)) continue;
+                fprintf(stderr, "bench: %s, %s workload, %s scale\n", engine->name, workload_name(w), scale->name);
+                struct bench_result result = bench_run(engine, input, &options);
+                bench_print_result(&options, engine->name, workload_name(w), scale, &result);
+            }
+            random_pairs_delete(input);
+        }
+    }
+    bench_print_footer(&options);
+    if (options.counters != NULL) perf_counters_close(options.counters);
+
+    return 0;
+}
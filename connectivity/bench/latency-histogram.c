@@ -0,0 +1,57 @@
+#include <string.h>
+#include <math.h>
+#include "latency-histogram.h"
+
+// 校准的时长(纳秒)
+#define LATENCY_CALIBRATION_NS 20000000
+
+static uint64_t latency_monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+double latency_ticks_per_ns(void) {
+    static double ticks_per_ns = 0;
+    if (ticks_per_ns > 0) return ticks_per_ns;
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t start_ns = latency_monotonic_ns(), start_ticks = latency_now(), end_ns;
+    while ((end_ns = latency_monotonic_ns()) - start_ns < LATENCY_CALIBRATION_NS);
+    uint64_t end_ticks = latency_now();
+    ticks_per_ns = (double)(end_ticks - start_ticks) / (end_ns - start_ns);
+#else
+    ticks_per_ns = 1;
+#endif
+    return ticks_per_ns;
+}
+
+void latency_histogram_reset(struct latency_histogram *histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+    return;
+}
+
+// 第bucket个桶内的最大值
+static uint64_t latency_bucket_high(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKET_NUM) return bucket;
+    int exponent = bucket / LATENCY_SUB_BUCKET_NUM + LATENCY_SUB_BUCKET_BITS - 1;
+    uint64_t sub_bucket = bucket % LATENCY_SUB_BUCKET_NUM;
+    int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    uint64_t low = (1ULL << exponent) | (sub_bucket << shift);
+    return low + ((1ULL << shift) - 1);
+}
+
+uint64_t latency_percentile(const struct latency_histogram *histogram, double quantile) {
+    if (histogram->total == 0) return 0;
+    // nearest-rank: 第ceil(quantile * total)个值
+    uint64_t rank = (uint64_t)ceil(quantile * histogram->total);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKET_NUM; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t high = latency_bucket_high(i);
+            return high < histogram->max ? high : histogram->max;
+        }
+    }
+    return histogram->max;
+}
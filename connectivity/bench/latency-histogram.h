@@ -0,0 +1,55 @@
+#ifndef HEADER_LATENCY_HISTOGRAM_H
+#define HEADER_LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 对数分桶的延迟直方图(与HdrHistogram相同的思路):
+// 小于LATENCY_SUB_BUCKET_NUM的值各占一个桶，
+// 更大的值按2的幂分段，每段再均分为LATENCY_SUB_BUCKET_NUM个桶，
+// 因此任何值的相对误差都不超过1/LATENCY_SUB_BUCKET_NUM，记录一个值只需要一次clz和一次移位
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKET_NUM (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKET_NUM ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_NUM)
+
+struct latency_histogram {
+    uint64_t counts[LATENCY_BUCKET_NUM];
+    uint64_t total, max;
+};
+
+static inline int latency_bucket(uint64_t value) {
+    if (value < LATENCY_SUB_BUCKET_NUM) return value;
+    int exponent = 63 - __builtin_clzll(value);
+    int sub_bucket = (value >> (exponent - LATENCY_SUB_BUCKET_BITS)) & (LATENCY_SUB_BUCKET_NUM - 1);
+    return (exponent - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_NUM + sub_bucket;
+}
+
+static inline void latency_record(struct latency_histogram *histogram, uint64_t value) {
+    histogram->counts[latency_bucket(value)]++;
+    histogram->total++;
+    if (value > histogram->max) histogram->max = value;
+}
+
+// 计时用的时钟，单位为tick: x86上是时间戳计数器，其他平台上是单调时钟的纳秒数
+static inline uint64_t latency_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+// 每纳秒的tick数，第一次调用时对照单调时钟校准
+double latency_ticks_per_ns(void);
+
+void latency_histogram_reset(struct latency_histogram *histogram);
+
+// 第quantile分位数(0到1之间)所在桶内的最大值，不超过记录过的最大值，没有记录时返回0
+uint64_t latency_percentile(const struct latency_histogram *histogram, double quantile);
+
+#endif // HEADER_LATENCY_HISTOGRAM_H
@@ -0,0 +1,93 @@
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perf-counters.h"
+
+// 每个事件单独打开而不组成一组，这样某个事件不被支持或计数器不够时，其余事件仍然可用，
+// 计数器被多路复用时按time_enabled / time_running折算
+struct perf_counter_config {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+};
+
+#define PERF_COUNTER_CACHE_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct perf_counter_config g_perf_counter_configs[PERF_COUNTER_NUM] = {
+    [PERF_COUNTER_CYCLES] = {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_COUNTER_INSTRUCTIONS] = {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_COUNTER_L1D_MISSES] = {"l1d_misses", PERF_TYPE_HW_CACHE, PERF_COUNTER_CACHE_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_COUNTER_LLC_MISSES] = {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_COUNTER_DTLB_MISSES] = {"dtlb_misses", PERF_TYPE_HW_CACHE, PERF_COUNTER_CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    [PERF_COUNTER_BRANCH_MISSES] = {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+};
+
+static int perf_counter_open_event(const struct perf_counter_config *config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = config->type;
+    attr.config = config->config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool perf_counters_open(struct perf_counters *counters) {
+    bool available = false;
+    int open_errno = 0;
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        counters->fds[i] = perf_counter_open_event(&g_perf_counter_configs[i]);
+        counters->values[i] = 0;
+        if (counters->fds[i] >= 0) available = true;
+        else if (open_errno == 0) open_errno = errno;
+    }
+    if (!available) errno = open_errno;
+    return available;
+}
+
+void perf_counters_start(struct perf_counters *counters) {
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        if (counters->fds[i] < 0) continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return;
+}
+
+void perf_counters_stop(struct perf_counters *counters) {
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        // value, time_enabled, time_running
+        uint64_t data[3];
+        counters->values[i] = 0;
+        if (counters->fds[i] < 0 || read(counters->fds[i], data, sizeof(data)) != sizeof(data)) continue;
+        if (data[2] == 0) continue;
+        counters->values[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+    }
+    return;
+}
+
+bool perf_counters_available(const struct perf_counters *counters, enum perf_counter_event event) {
+    return counters->fds[event] >= 0;
+}
+
+void perf_counters_close(struct perf_counters *counters) {
+    for (int i = 0; i < PERF_COUNTER_NUM; i++) {
+        if (counters->fds[i] >= 0) close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+    return;
+}
+
+const char *perf_counter_name(enum perf_counter_event event) {
+    return g_perf_counter_configs[event].name;
+}
@@ -0,0 +1,41 @@
+#ifndef HEADER_PERF_COUNTERS_H
+#define HEADER_PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 用perf_event_open统计的硬件事件，只统计用户态
+enum perf_counter_event {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_L1D_MISSES,
+    PERF_COUNTER_LLC_MISSES,
+    PERF_COUNTER_DTLB_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_NUM
+};
+
+// fds中某个事件为-1表示该事件不可用(内核、虚拟机或权限不支持)，
+// values为最近一次perf_counters_stop得到的计数，已按多路复用的运行时间比例折算
+struct perf_counters {
+    int fds[PERF_COUNTER_NUM];
+    uint64_t values[PERF_COUNTER_NUM];
+};
+
+// 打开当前线程上的所有计数器，任何一个事件可用时返回true，否则返回false并在errno中保留原因
+bool perf_counters_open(struct perf_counters *counters);
+
+// 清零并开始计数
+void perf_counters_start(struct perf_counters *counters);
+
+// 停止计数并读取values
+void perf_counters_stop(struct perf_counters *counters);
+
+bool perf_counters_available(const struct perf_counters *counters, enum perf_counter_event event);
+
+void perf_counters_close(struct perf_counters *counters);
+
+// 事件的名称，用作输出中的列名前缀
+const char *perf_counter_name(enum perf_counter_event event);
+
+#endif // HEADER_PERF_COUNTERS_H
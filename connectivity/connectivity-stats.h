@@ -0,0 +1,101 @@
+#ifndef HEADER_CONNECTIVITY_STATS_H
+#define HEADER_CONNECTIVITY_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/****************************************
+ * @ingroup ConnectivityStats
+ *
+ * 搜索与联合操作统计的头文件。
+ *
+ * 各算法文件的搜索操作和联合操作中插入了本文件定义的宏。
+ * 只有编译时定义了CONNECTIVITY_STATS(例如make DEFS=-DCONNECTIVITY_STATS)时这些宏才会记录数据，
+ * 否则它们全部展开为空语句，不会在热循环中留下任何指令。
+ ****************************************/
+
+/**
+ * @brief 路径长度直方图与联合规模分类的桶数。
+ *
+ * 第0个桶为0，第k个桶为[2^(k-1), 2^k)。
+ */
+#define CONNECTIVITY_STATS_CLASS_NUM 34
+
+#ifdef CONNECTIVITY_STATS
+
+/**
+ * @brief 当前线程上的统计数据。
+ *
+ * 路径长度是一次追溯中沿父节点指针移动的次数，
+ * 路径减半时每次移动跨过两层，因此不使用路径减半的算法中它就是对象的深度。
+ */
+struct connectivity_stats {
+    uint64_t find_num;                ///< 追溯根节点的次数，每个对象算一次
+    uint64_t hop_num;                 ///< 所有追溯的路径长度之和
+    uint64_t max_path_length;         ///< 观察到的最大路径长度
+    uint64_t compression_write_num;   ///< 路径压缩修改父节点的次数
+    uint64_t union_num;               ///< 联合的次数
+    uint64_t unsized_union_num;       ///< 其中不知道树的节点数的联合的次数
+    uint64_t path_length[CONNECTIVITY_STATS_CLASS_NUM];   ///< 路径长度的直方图
+    uint64_t union_size[CONNECTIVITY_STATS_CLASS_NUM];    ///< 按被连接到下方的树的节点数分类的联合次数
+};
+
+extern _Thread_local struct connectivity_stats g_connectivity_stats;
+
+static inline int connectivity_stats_class(uint64_t value) {
+    if (value == 0) return 0;
+    int k = 64 - __builtin_clzll(value);
+    return k < CONNECTIVITY_STATS_CLASS_NUM ? k : CONNECTIVITY_STATS_CLASS_NUM - 1;
+}
+
+static inline void connectivity_stats_find(uint64_t *hops) {
+    g_connectivity_stats.find_num++;
+    g_connectivity_stats.hop_num += *hops;
+    g_connectivity_stats.path_length[connectivity_stats_class(*hops)]++;
+    if (*hops > g_connectivity_stats.max_path_length) g_connectivity_stats.max_path_length = *hops;
+    *hops = 0;
+    return;
+}
+
+static inline void connectivity_stats_union(uint64_t size) {
+    g_connectivity_stats.union_num++;
+    if (size == 0) g_connectivity_stats.unsized_union_num++;
+    else g_connectivity_stats.union_size[connectivity_stats_class(size)]++;
+    return;
+}
+
+void connectivity_stats_reset(void);
+void connectivity_stats_print(FILE *stream);
+
+/**
+ * @brief 在一个搜索操作的开头声明路径长度计数器。
+ */
+#define CONNECTIVITY_STATS_FIND_BEGIN() uint64_t connectivity_stats_hops = 0
+/**
+ * @brief 沿父节点指针移动一次。
+ */
+#define CONNECTIVITY_STATS_HOP() (connectivity_stats_hops++)
+/**
+ * @brief 一次追溯结束，记录路径长度并清零计数器，同一个搜索操作中可以追溯多次。
+ */
+#define CONNECTIVITY_STATS_FIND_END() connectivity_stats_find(&connectivity_stats_hops)
+#define CONNECTIVITY_STATS_COMPRESSION_WRITE() (g_connectivity_stats.compression_write_num++)
+/**
+ * @brief 一次联合，size为被连接到下方的树的节点数，不知道节点数时为0。
+ */
+#define CONNECTIVITY_STATS_UNION(size) connectivity_stats_union(size)
+
+#else // #ifdef CONNECTIVITY_STATS
+
+#define connectivity_stats_reset() ((void)0)
+#define connectivity_stats_print(stream) ((void)(stream))
+
+#define CONNECTIVITY_STATS_FIND_BEGIN() ((void)0)
+#define CONNECTIVITY_STATS_HOP() ((void)0)
+#define CONNECTIVITY_STATS_FIND_END() ((void)0)
+#define CONNECTIVITY_STATS_COMPRESSION_WRITE() ((void)0)
+#define CONNECTIVITY_STATS_UNION(size) ((void)sizeof(size))
+
+#endif // #ifdef CONNECTIVITY_STATS
+
+#endif // HEADER_CONNECTIVITY_STATS_H
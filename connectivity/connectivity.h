@@ -2,6 +2,9 @@
 #define HEADER_CONNECTIVITY_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 /****************************************
  * @defgroup Connectivity
@@ -106,26 +109,53 @@
 int *qfind_new_storage(size_t object_num);
 void qfind_delete_storage(int *storage);
 bool qfind_is_new_connection(int *storage, size_t object_num, int p, int q);
+int qfind_find(const int *storage, int p);
+bool qfind_connected(const int *storage, int p, int q);
 
 int *qunion_new_storage(size_t object_num);
 void qunion_delete_storage(int *storage);
 bool qunion_is_new_connection(int *storage, int p, int q);
+int qunion_find(const int *storage, int p);
+bool qunion_connected(const int *storage, int p, int q);
 
+/**
+ * @brief 加权算法的存储结构。
+ *
+ * next把同一个连通分量中的对象串成一个环，为NULL时不维护(例如映射到文件的存储)，
+ * component_num为当前连通分量的个数。
+ */
 struct storage_with_tree_size {
     int *data, *tree_size;
+    int *next;
+    size_t component_num;
 };
 
 struct storage_with_tree_size *w_qunion_new_storage(size_t object_num);
 void w_qunion_delete_storage(struct storage_with_tree_size *storage);
 bool w_qunion_is_new_connection(struct storage_with_tree_size *storage, int p, int q);
+int w_qunion_find(const struct storage_with_tree_size *storage, int p);
+bool w_qunion_connected(const struct storage_with_tree_size *storage, int p, int q);
 
 struct storage_with_tree_size *w_qunion_pc_new_storage(size_t object_num);
 void w_qunion_pc_delete_storage(struct storage_with_tree_size *storage);
 bool w_qunion_pc_is_new_connection(struct storage_with_tree_size *storage, int p, int q);
+int w_qunion_pc_find(struct storage_with_tree_size *storage, int p);
+bool w_qunion_pc_connected(struct storage_with_tree_size *storage, int p, int q);
+int w_qunion_pc_find_readonly(const struct storage_with_tree_size *storage, int p);
+bool w_qunion_pc_connected_readonly(const struct storage_with_tree_size *storage, int p, int q);
 
 struct storage_with_tree_size *w_qunion_pc_h_new_storage(size_t object_num);
 void w_qunion_pc_h_delete_storage(struct storage_with_tree_size *storage);
 bool w_qunion_pc_h_is_new_connection(struct storage_with_tree_size *storage, int p, int q);
+int w_qunion_pc_h_find(struct storage_with_tree_size *storage, int p);
+bool w_qunion_pc_h_connected(struct storage_with_tree_size *storage, int p, int q);
+int w_qunion_pc_h_find_readonly(const struct storage_with_tree_size *storage, int p);
+bool w_qunion_pc_h_connected_readonly(const struct storage_with_tree_size *storage, int p, int q);
+void w_qunion_pc_h_process_batch(struct storage_with_tree_size *storage, int (*pairs)[2], size_t pair_num, unsigned char *out_bitmap);
+
+size_t w_qunion_component_count(const struct storage_with_tree_size *storage);
+int w_qunion_component_size(const struct storage_with_tree_size *storage, int p);
+int w_qunion_component_members(const struct storage_with_tree_size *storage, int p, int *members);
 
 struct storage_with_tree_height {
     int *data, *tree_height;
@@ -134,6 +164,218 @@ struct storage_with_tree_height {
 struct storage_with_tree_height *h_qunion_new_storage(size_t object_num);
 void h_qunion_delete_storage(struct storage_with_tree_height *storage);
 bool h_qunion_is_new_connection(struct storage_with_tree_height *storage, int p, int q);
+int h_qunion_find(const struct storage_with_tree_height *storage, int p);
+bool h_qunion_connected(const struct storage_with_tree_height *storage, int p, int q);
+
+struct concurrent_storage {
+    _Atomic int *data;
+    size_t object_num;
+};
+
+struct concurrent_storage *c_qunion_new_storage(size_t object_num);
+void c_qunion_delete_storage(struct concurrent_storage *storage);
+bool c_qunion_is_new_connection(struct concurrent_storage *storage, int p, int q);
+bool c_qunion_connected(struct concurrent_storage *storage, int p, int q);
+int c_qunion_find(struct concurrent_storage *storage, int p);
+int c_qunion_find_readonly(struct concurrent_storage *storage, int p);
+bool c_qunion_connected_readonly(struct concurrent_storage *storage, int p, int q);
+
+struct rw_storage {
+    _Atomic int *data;
+    int *tree_size;
+    size_t object_num;
+};
+
+struct rw_storage *rw_qunion_new_storage(size_t object_num);
+void rw_qunion_delete_storage(struct rw_storage *storage);
+bool rw_qunion_is_new_connection(struct rw_storage *storage, int p, int q);
+int rw_qunion_find(const struct rw_storage *storage, int p);
+bool rw_qunion_connected(const struct rw_storage *storage, int p, int q);
+
+/**
+ * @brief 离线并行连通分量算法的结果，labels[i]为对象i所在连通分量中序号最小的对象。
+ */
+struct cc_labels {
+    int *labels;
+    size_t object_num;
+    size_t component_num;
+};
+
+struct cc_labels *p_cc_new_labels(int (*pairs)[2], size_t pair_num, size_t object_num, int thread_num);
+void p_cc_delete_labels(struct cc_labels *labels);
+bool p_cc_process_batch(int (*pairs)[2], size_t pair_num, size_t object_num, int thread_num, unsigned char *out_bitmap);
+
+/**
+ * @brief Rollback-weighted-quick-union算法的存储结构，undo按联合的顺序记录被连接到下方的根节点。
+ */
+struct rollback_storage {
+    int *data, *tree_size;
+    int *undo;
+    size_t undo_num;
+    size_t object_num;
+    size_t component_num;
+};
+
+struct rollback_storage *rb_qunion_new_storage(size_t object_num);
+void rb_qunion_delete_storage(struct rollback_storage *storage);
+bool rb_qunion_is_new_connection(struct rollback_storage *storage, int p, int q);
+int rb_qunion_find(const struct rollback_storage *storage, int p);
+bool rb_qunion_connected(const struct rollback_storage *storage, int p, int q);
+size_t rb_qunion_checkpoint(const struct rollback_storage *storage);
+bool rb_qunion_rollback(struct rollback_storage *storage, size_t checkpoint);
+
+enum dynamic_operation_type {
+    DYNAMIC_INSERT,
+    DYNAMIC_DELETE,
+    DYNAMIC_QUERY
+};
+
+/**
+ * @brief 离线动态连通性算法的一个操作: 插入或删除p、q之间的连接，或查询p、q是否已连接。
+ */
+struct dynamic_operation {
+    enum dynamic_operation_type type;
+    int p, q;
+};
+
+bool od_process_batch(const struct dynamic_operation *operations, size_t operation_num, size_t object_num,
+                      unsigned char *out_bitmap);
+
+/**
+ * @brief Versioned-weighted-quick-union算法中根节点的时间戳，也表示两个对象尚未连接。
+ */
+#define VR_QUNION_NEVER SIZE_MAX
+
+/**
+ * @brief Versioned-weighted-quick-union算法的存储结构，stamp[i]为节点i被连接到其他树下时的版本。
+ */
+struct versioned_storage {
+    int *data, *tree_size;
+    size_t *stamp;
+    size_t version;
+    size_t object_num;
+};
+
+struct versioned_storage *vr_qunion_new_storage(size_t object_num);
+void vr_qunion_delete_storage(struct versioned_storage *storage);
+bool vr_qunion_is_new_connection(struct versioned_storage *storage, int p, int q);
+size_t vr_qunion_version(const struct versioned_storage *storage);
+int vr_qunion_find(const struct versioned_storage *storage, int p);
+bool vr_qunion_connected(const struct versioned_storage *storage, int p, int q);
+int vr_qunion_find_at(const struct versioned_storage *storage, int p, size_t version);
+bool vr_qunion_connected_at(const struct versioned_storage *storage, int p, int q, size_t version);
+size_t vr_qunion_connected_since(const struct versioned_storage *storage, int p, int q);
+
+enum storage_64_layout {
+    STORAGE_64_WIDE,
+    STORAGE_64_PACKED40
+};
+
+struct storage_64 {
+    int64_t *data;
+    unsigned char *packed;
+    int64_t object_num;
+    enum storage_64_layout layout;
+};
+
+struct storage_64 *w_qunion_64_new_storage(int64_t object_num, enum storage_64_layout layout);
+void w_qunion_64_delete_storage(struct storage_64 *storage);
+bool w_qunion_64_is_new_connection(struct storage_64 *storage, int64_t p, int64_t q);
+int64_t w_qunion_64_find(const struct storage_64 *storage, int64_t p);
+bool w_qunion_64_connected(const struct storage_64 *storage, int64_t p, int64_t q);
+
+struct storage_64 *w_qunion_pc_h_64_new_storage(int64_t object_num, enum storage_64_layout layout);
+void w_qunion_pc_h_64_delete_storage(struct storage_64 *storage);
+bool w_qunion_pc_h_64_is_new_connection(struct storage_64 *storage, int64_t p, int64_t q);
+int64_t w_qunion_pc_h_64_find(struct storage_64 *storage, int64_t p);
+bool w_qunion_pc_h_64_connected(struct storage_64 *storage, int64_t p, int64_t q);
+int64_t w_qunion_pc_h_64_find_readonly(const struct storage_64 *storage, int64_t p);
+bool w_qunion_pc_h_64_connected_readonly(const struct storage_64 *storage, int64_t p, int64_t q);
+
+enum mmap_storage_engine {
+    MMAP_STORAGE_W_QUNION = 1,
+    MMAP_STORAGE_W_QUNION_PC,
+    MMAP_STORAGE_W_QUNION_PC_H
+};
+
+struct mmap_storage {
+    struct storage_with_tree_size storage;
+    void *base;
+    size_t length;
+    int fd;
+};
+
+struct mmap_storage *mmap_storage_open(const char *path, enum mmap_storage_engine engine, size_t object_num);
+bool mmap_storage_sync(struct mmap_storage *storage);
+void mmap_storage_close(struct mmap_storage *storage);
+
+struct uf_storage;
+
+/**
+ * @brief Keyed-quick-union算法哈希表的槽位，distance为探测距离加1，0表示空槽位。
+ */
+struct keyed_slot {
+    uint64_t key;
+    int index;
+    uint32_t distance;
+};
+
+struct keyed_storage {
+    struct keyed_slot *slots;
+    size_t slot_mask;
+    size_t key_num;
+    struct uf_storage *uf;
+};
+
+struct keyed_storage *k_qunion_new_storage(size_t expected_key_num);
+void k_qunion_delete_storage(struct keyed_storage *storage);
+int k_qunion_index(struct keyed_storage *storage, uint64_t key);
+void k_qunion_index_batch(struct keyed_storage *storage, const uint64_t *keys, size_t key_num, int *indices);
+bool k_qunion_is_new_connection(struct keyed_storage *storage, uint64_t p, uint64_t q);
+int k_qunion_find(struct keyed_storage *storage, uint64_t key);
+bool k_qunion_connected(struct keyed_storage *storage, uint64_t p, uint64_t q);
+bool k_qunion_connected_readonly(const struct keyed_storage *storage, uint64_t p, uint64_t q);
+void k_qunion_process_batch(struct keyed_storage *storage, uint64_t (*pairs)[2], size_t pair_num, unsigned char *out_bitmap);
+
+/**
+ * @brief 映射到内存的输入对文件，index_width为4时pairs有效，为8时pairs_64有效。
+ */
+struct pair_file {
+    int (*pairs)[2];
+    int64_t (*pairs_64)[2];
+    int64_t object_num, pair_num;
+    int index_width;
+    void *base;
+    size_t length;
+};
+
+bool pair_file_write(const char *path, int64_t object_num, int64_t pair_num, int index_width, const void *pairs);
+struct pair_file *pair_file_open(const char *path);
+bool pair_file_validate(const struct pair_file *file);
+void pair_file_close(struct pair_file *file);
+
+enum pair_text_status {
+    PAIR_TEXT_OK,
+    PAIR_TEXT_FULL,
+    PAIR_TEXT_OUT_OF_RANGE,
+    PAIR_TEXT_INVALID_CHARACTER
+};
+
+/**
+ * @brief 文本输入对的解析状态，pending为已读到、尚未配对的整数，没有时为-1。
+ */
+struct pair_text_parser {
+    int (*pairs)[2];
+    size_t pair_capacity, pair_len;
+    long long object_num;
+    long long pending;
+    long long offset;
+};
+
+void pair_text_init(struct pair_text_parser *parser, int object_num, int (*pairs)[2], size_t pair_capacity);
+bool pair_text_is_space(char c);
+enum pair_text_status pair_text_parse(struct pair_text_parser *parser, const char *begin, const char *end, const char **stop);
+const char *pair_text_error(enum pair_text_status status);
 
 #endif // #ifndef DOC_COMPILE
 
@@ -3,60 +3,115 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include "connectivity.h"
+#include "random-pairs.h"
 
-int main(int argc, char *argv[]) {
-	if (argc != 3) {
-		fprintf(stderr, "sytnax: %s object_num pair_num\n", argv[0]);
-		exit(-1);
-	}
+static void print_syntax(const char *program) {
+	fprintf(stderr, "sytnax: %s [-o output_file] [-s seed] [-t thread_num] object_num pair_num\n", program);
+	exit(-1);
+}
 
+int main(int argc, char *argv[]) {
+	const char *output_path = NULL;
+	uint64_t seed = RANDOM_PAIRS_DEFAULT_SEED;
+	int thread_num = 0;
 	char *str_end = NULL;
 	bool range_err;
+	int option;
+	while ((option = getopt(argc, argv, "o:s:t:")) != -1) {
+		switch (option) {
+		case 'o':
+			output_path = optarg;
+			break;
+		case 's':
+			errno = 0;
+			seed = strtoull(optarg, &str_end, 0);
+			if (errno == ERANGE || str_end[0] != '\0') {
+				fprintf(stderr, "invalid seed value.\n");
+				exit(-1);
+			}
+			break;
+		case 't':
+			thread_num = strtol(optarg, &str_end, 0);
+			if (str_end[0] != '\0' || thread_num < 1 || thread_num > 1024) {
+				fprintf(stderr, "thread_num out of range.\n");
+				exit(-1);
+			}
+			break;
+		default:
+			print_syntax(argv[0]);
+		}
+	}
+	if (argc - optind != 2) print_syntax(argv[0]);
+	argv += optind - 1;
 	
 	errno = 0;
-	long input_num_1 = strtol(argv[1], &str_end, 0);
+	long long input_num_1 = strtoll(argv[1], &str_end, 0);
 	range_err = errno == ERANGE;
 	if (str_end[0] != '\0') {
 		fprintf(stderr, "invalid object_num value.\n");
 		exit(-1);
 	}
-	if (range_err || input_num_1 < 2 || input_num_1 > INT_MAX) {
+	if (range_err || input_num_1 < 2) {
 		fprintf(stderr, "object_num out of range.\n");
 		exit(-1);
 	}
 
 
 	errno = 0;
-	long input_num_2 = strtol(argv[2], &str_end, 0);
+	long long input_num_2 = strtoll(argv[2], &str_end, 0);
 	range_err = errno == ERANGE;
 	if (str_end[0] != '\0') {
 		fprintf(stderr, "invalid pair_num value.\n");
 		exit(-1);
 	}
-	if (range_err || input_num_2 < 0 || input_num_2 > INT_MAX) {
+	if (range_err || input_num_2 < 0 || (unsigned long long)input_num_2 > SIZE_MAX / sizeof(int64_t[2])) {
 		fprintf(stderr, "pair_num out of range.\n");
 		exit(-1);
 	}
 	
-	int object_num = (int)input_num_1;
-	int pair_num = (int)input_num_2;
-	int (*pairs)[2] = malloc(sizeof(pairs) * pair_num);
+	// 对象数超过INT_MAX时，序号需要用64位整数表示
+	int64_t object_num = input_num_1;
+	int64_t pair_num = input_num_2;
+	int64_t (*pairs)[2] = malloc(sizeof(*pairs) * pair_num);
+	if (pairs == NULL) {
+		fprintf(stderr, "not enough memory for %lld pairs.\n", input_num_2);
+		exit(-1);
+	}
 	
-	clock_t start_time = clock();
+	// 多线程生成，clock()会累计所有线程的CPU时间，因此使用单调时钟
+	struct timespec start_time, end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
 	
-	for (int i = 0; i < pair_num; i++) {
-		pairs[i][0] = rand() % object_num;
-		do {
-			pairs[i][1] = rand() % object_num;
-		} while (pairs[i][1] == pairs[i][0]);
-	}
+	random_pairs_64_fill(pairs, object_num, pair_num, seed, thread_num);
 
-	clock_t end_time = clock();
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
 	
-	double cpu_time_used = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+	double time_used = (double)(end_time.tv_sec - start_time.tv_sec) + (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 	
-	printf("pair generation took %f seconds to complete.\n", cpu_time_used);
+	printf("pair generation took %f seconds to complete.\n", time_used);
+
+	if (output_path != NULL) {
+		// 序号都能用int表示时，就地压缩为int输入对，文件大小减半
+		int index_width = sizeof(int64_t);
+		if (object_num <= (int64_t)INT_MAX + 1) {
+			for (int64_t i = 0; i < pair_num; i++) {
+				int pair[2] = {pairs[i][0], pairs[i][1]};
+				memcpy((char *)pairs + sizeof(pair) * i, pair, sizeof(pair));
+			}
+			index_width = sizeof(int);
+		}
+		if (!pair_file_write(output_path, object_num, pair_num, index_width, pairs)) {
+			fprintf(stderr, "fail to write %s.\n", output_path);
+			free(pairs);
+			exit(-1);
+		}
+		printf("%lld pairs written to %s.\n", (long long)pair_num, output_path);
+	}
 	
 	free(pairs);
 	return 0;
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "random-pairs.h"
+#include "concurrent-runner.h"
+
+// 一个线程负责的输入对区间
+struct concurrent_task {
+    struct concurrent_storage *storage;
+    int (*pairs)[2];
+    int begin, end;
+    long long new_connection_num;
+};
+
+static void *concurrent_worker(void *arg) {
+    struct concurrent_task *task = arg;
+    long long new_connection_num = 0;
+    for (int i = task->begin; i < task->end; i++) {
+        if (c_qunion_is_new_connection(task->storage, task->pairs[i][0], task->pairs[i][1])) new_connection_num++;
+    }
+    task->new_connection_num = new_connection_num;
+    return NULL;
+}
+
+// 将输入对平均分给thread_num个线程同时处理，返回所有线程报告的新连接总数，失败时返回-1
+long long concurrent_run_pairs(struct concurrent_storage *storage, int (*pairs)[2], int pair_num, int thread_num) {
+    pthread_t *threads = malloc(sizeof(*threads) * thread_num);
+    struct concurrent_task *tasks = malloc(sizeof(*tasks) * thread_num);
+    if (threads == NULL || tasks == NULL) {
+        free(threads);
+        free(tasks);
+        return -1;
+    }
+
+    int started = 0;
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].storage = storage;
+        tasks[t].pairs = pairs;
+        tasks[t].begin = (long long)pair_num * t / thread_num;
+        tasks[t].end = (long long)pair_num * (t + 1) / thread_num;
+        tasks[t].new_connection_num = 0;
+        if (pthread_create(&threads[t], NULL, concurrent_worker, &tasks[t]) != 0) break;
+        started++;
+    }
+
+    long long new_connection_num = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        new_connection_num += tasks[t].new_connection_num;
+    }
+
+    free(threads);
+    free(tasks);
+    return started == thread_num ? new_connection_num : -1;
+}
+
+// 写线程每处理这么多个输入对公布一次进度，避免读线程每次查询都读取写线程刚修改的cache line
+#define RW_PROGRESS_INTERVAL 256
+
+// 一个写线程与多个读线程共享的状态
+struct rw_shared {
+    struct rw_storage *storage;
+    int (*pairs)[2];
+    int pair_num;
+    atomic_int progress;        // 写线程已处理完的输入对个数，前progress个输入对必定已连接
+    atomic_bool done;
+    long long new_connection_num;
+};
+
+struct rw_reader {
+    struct rw_shared *shared;
+    uint64_t state;
+    long long query_num, missed_num;
+};
+
+static void *rw_writer(void *arg) {
+    struct rw_shared *shared = arg;
+    long long new_connection_num = 0;
+    for (int i = 0; i < shared->pair_num; i++) {
+        if (rw_qunion_is_new_connection(shared->storage, shared->pairs[i][0], shared->pairs[i][1])) new_connection_num++;
+        if ((i + 1) % RW_PROGRESS_INTERVAL == 0) atomic_store_explicit(&shared->progress, i + 1, memory_order_release);
+    }
+    atomic_store_explicit(&shared->progress, shared->pair_num, memory_order_release);
+    shared->new_connection_num = new_connection_num;
+    atomic_store_explicit(&shared->done, true, memory_order_release);
+    return NULL;
+}
+
+// 交替查询一个已处理的输入对(必定已连接)和两个随机对象(结果不确定)，直到写线程结束
+static void *rw_reader(void *arg) {
+    struct rw_reader *reader = arg;
+    struct rw_shared *shared = reader->shared;
+    long long query_num = 0, missed_num = 0;
+    while (!atomic_load_explicit(&shared->done, memory_order_acquire)) {
+        int progress = atomic_load_explicit(&shared->progress, memory_order_acquire);
+        if (progress == 0) continue;
+        int i = random_pairs_below(&reader->state, progress);
+        if (!rw_qunion_connected(shared->storage, shared->pairs[i][0], shared->pairs[i][1])) missed_num++;
+        int j = random_pairs_below(&reader->state, shared->pair_num);
+        rw_qunion_connected(shared->storage, shared->pairs[i][0], shared->pairs[j][1]);
+        query_num += 2;
+    }
+    reader->query_num = query_num;
+    reader->missed_num = missed_num;
+    return NULL;
+}
+
+// 一个写线程依次处理所有输入对，同时reader_num个读线程不断查询，返回写线程报告的新连接数，失败时返回-1
+// query_num为读线程完成的查询总数，missed_num为已处理的输入对被判断为未连接的次数(正确时为0)
+long long rw_run_pairs(struct rw_storage *storage, int (*pairs)[2], int pair_num, int reader_num,
+                       long long *query_num, long long *missed_num) {
+    pthread_t *threads = malloc(sizeof(*threads) * (reader_num + 1));
+    struct rw_reader *readers = malloc(sizeof(*readers) * (reader_num + 1));
+    if (threads == NULL || readers == NULL) {
+        free(threads);
+        free(readers);
+        return -1;
+    }
+
+    struct rw_shared shared = {.storage = storage, .pairs = pairs, .pair_num = pair_num, .new_connection_num = 0};
+    atomic_init(&shared.progress, 0);
+    atomic_init(&shared.done, false);
+
+    int started = 0;
+    for (int t = 0; t < reader_num; t++) {
+        readers[t].shared = &shared;
+        readers[t].state = random_pairs_stream(RANDOM_PAIRS_DEFAULT_SEED, t);
+        readers[t].query_num = readers[t].missed_num = 0;
+        if (pthread_create(&threads[t], NULL, rw_reader, &readers[t]) != 0) break;
+        started++;
+    }
+    // 读线程创建失败时仍要启动写线程，否则已启动的读线程不会结束
+    bool writer_started = pthread_create(&threads[reader_num], NULL, rw_writer, &shared) == 0;
+    if (!writer_started) atomic_store(&shared.done, true);
+
+    *query_num = *missed_num = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        *query_num += readers[t].query_num;
+        *missed_num += readers[t].missed_num;
+    }
+    if (writer_started) pthread_join(threads[reader_num], NULL);
+
+    free(threads);
+    free(readers);
+    return started == reader_num && writer_started ? shared.new_connection_num : -1;
+}
+
+// 测试使用的最大线程数，即在线的CPU核数
+int concurrent_max_thread_num(void) {
+    long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpu_num < 1 ? 1 : (int)cpu_num;
+}
@@ -0,0 +1,11 @@
+#ifndef HEADER_CONCURRENT_RUNNER_H
+#define HEADER_CONCURRENT_RUNNER_H
+
+#include "connectivity.h"
+
+long long concurrent_run_pairs(struct concurrent_storage *storage, int (*pairs)[2], int pair_num, int thread_num);
+long long rw_run_pairs(struct rw_storage *storage, int (*pairs)[2], int pair_num, int reader_num,
+                       long long *query_num, long long *missed_num);
+int concurrent_max_thread_num(void);
+
+#endif // HEADER_CONCURRENT_RUNNER_H
@@ -0,0 +1,18 @@
+#ifndef HEADER_MEMORY_UTILS_H
+#define HEADER_MEMORY_UTILS_H
+
+#include <stdio.h>
+#include <unistd.h>
+
+// 读取当前进程实际占用的物理内存(KB)，读取失败时返回-1
+static inline long get_resident_memory_kb(void) {
+    long total_pages = 0, resident_pages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL) return -1;
+    int matched = fscanf(statm, "%ld %ld", &total_pages, &resident_pages);
+    fclose(statm);
+    if (matched != 2) return -1;
+    return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+#endif // HEADER_MEMORY_UTILS_H
@@ -1,28 +1,179 @@
 #include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "connectivity.h"
 #include "random-pairs.h"
 
+// 生成器的设计:
+// - 第i个输入对只由种子和i决定(基于计数器的随机数生成器)，
+//   因此可以把输入对任意分给多个线程生成，结果与线程数无关。
+// - 第i个输入对使用一个独立的SplitMix64序列，其初始状态是以种子为初值的SplitMix64序列的第i个输出。
+// - 用Lemire的乘法方法把64位随机数映射到[0, n)，拒绝少量结果以消除取模带来的偏差。
+// - 后一个对象从[0, n-1)中选取，不小于前一个对象时加1，
+//   这样两个对象必然不同且仍是均匀分布，不需要重新选取。
+
+// 每个线程至少负责的输入对个数
+#define RANDOM_PAIRS_MIN_CHUNK 65536
+
+static inline void random_pairs_generate(uint64_t seed, uint64_t index, uint64_t object_num, int64_t pair[2]) {
+    uint64_t state = random_pairs_stream(seed, index);
+    uint64_t p = random_pairs_below(&state, object_num);
+    uint64_t q = random_pairs_below(&state, object_num - 1);
+    pair[0] = p;
+    pair[1] = q >= p ? q + 1 : q;
+}
+
+// 一个线程负责的输入对区间，pairs和pairs_64只有一个不为NULL
+struct random_pairs_task {
+    int (*pairs)[2];
+    int64_t (*pairs_64)[2];
+    uint64_t seed, object_num;
+    int64_t begin, end;
+};
+
+static void *random_pairs_worker(void *arg) {
+    struct random_pairs_task *task = arg;
+    int64_t pair[2];
+    for (int64_t i = task->begin; i < task->end; i++) {
+        random_pairs_generate(task->seed, i, task->object_num, pair);
+        if (task->pairs != NULL) {
+            task->pairs[i][0] = pair[0];
+            task->pairs[i][1] = pair[1];
+        } else {
+            task->pairs_64[i][0] = pair[0];
+            task->pairs_64[i][1] = pair[1];
+        }
+    }
+    return NULL;
+}
+
+// 将输入对平均分给thread_num个线程生成，线程创建失败时由当前线程补做
+static void random_pairs_run(int (*pairs)[2], int64_t (*pairs_64)[2], int64_t object_num, int64_t pair_num,
+                             uint64_t seed, int thread_num) {
+    if (thread_num <= 0) {
+        long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_num = cpu_num < 1 ? 1 : (int)cpu_num;
+    }
+    // 避免为少量输入对创建线程
+    if (pair_num / RANDOM_PAIRS_MIN_CHUNK < thread_num) thread_num = pair_num / RANDOM_PAIRS_MIN_CHUNK + 1;
+
+    pthread_t threads[thread_num];
+    struct random_pairs_task tasks[thread_num];
+    bool started[thread_num];
+    seed = random_pairs_mix(seed);
+    for (int t = 0; t < thread_num; t++) {
+        tasks[t].pairs = pairs;
+        tasks[t].pairs_64 = pairs_64;
+        tasks[t].seed = seed;
+        tasks[t].object_num = object_num;
+        tasks[t].begin = pair_num / thread_num * t + (t < pair_num % thread_num ? t : pair_num % thread_num);
+        tasks[t].end = tasks[t].begin + pair_num / thread_num + (t < pair_num % thread_num ? 1 : 0);
+        started[t] = t > 0 && pthread_create(&threads[t], NULL, random_pairs_worker, &tasks[t]) == 0;
+    }
+    for (int t = 0; t < thread_num; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+        else random_pairs_worker(&tasks[t]);
+    }
+    return;
+}
+
+void random_pairs_fill(int (*pairs)[2], int object_num, int pair_num, uint64_t seed, int thread_num) {
+    random_pairs_run(pairs, NULL, object_num, pair_num, seed, thread_num);
+}
+
+void random_pairs_64_fill(int64_t (*pairs)[2], int64_t object_num, int64_t pair_num, uint64_t seed, int thread_num) {
+    random_pairs_run(NULL, pairs, object_num, pair_num, seed, thread_num);
+}
+
 struct random_pairs *random_pairs_new(int object_num, int pair_num) {
+    return random_pairs_new_seeded(object_num, pair_num, RANDOM_PAIRS_DEFAULT_SEED, 0);
+}
+
+struct random_pairs *random_pairs_new_seeded(int object_num, int pair_num, uint64_t seed, int thread_num) {
     if (object_num < 2 || pair_num < 0) return NULL;
 
-    int (*pairs)[2] = malloc(sizeof(pairs) * pair_num);
+    int (*pairs)[2] = malloc(sizeof(*pairs) * pair_num);
     if (pairs == NULL) return NULL;
     
-    for (int i = 0; i < pair_num; i++) {
-		pairs[i][0] = rand() % object_num;
-		do {
-			pairs[i][1] = rand() % object_num;
-		} while (pairs[i][1] == pairs[i][0]);
-	}
+    random_pairs_fill(pairs, object_num, pair_num, seed, thread_num);
 
     struct random_pairs *res = malloc(sizeof(*res));
-    if (res == NULL) return NULL;
+    if (res == NULL) {
+        free(pairs);
+        return NULL;
+    }
     
     res->pairs = pairs;
+    res->object_num = object_num;
+    res->pair_num = pair_num;
+    res->file = NULL;
+
+    return res;
+}
+
+// 载入由random_pairs_write写出的输入对文件，不复制文件内容
+struct random_pairs *random_pairs_load(const char *path) {
+    struct pair_file *file = pair_file_open(path);
+    if (file == NULL) return NULL;
+    if (file->index_width != 4 || file->object_num > INT32_MAX || file->pair_num > INT32_MAX) {
+        pair_file_close(file);
+        return NULL;
+    }
+
+    struct random_pairs *res = malloc(sizeof(*res));
+    if (res == NULL) {
+        pair_file_close(file);
+        return NULL;
+    }
+
+    res->pairs = file->pairs;
+    res->object_num = file->object_num;
+    res->pair_num = file->pair_num;
+    res->file = file;
 
     return res;
 }
 
+bool random_pairs_write(const struct random_pairs *pairs, const char *path) {
+    return pair_file_write(path, pairs->object_num, pairs->pair_num, sizeof(int), pairs->pairs);
+}
+
 void random_pairs_delete(struct random_pairs *pairs) {
+    if (pairs != NULL) {
+        if (pairs->file != NULL) pair_file_close(pairs->file);
+        else free(pairs->pairs);
+        free(pairs);
+    }
+
+    return;
+}
+
+struct random_pairs_64 *random_pairs_64_new(int64_t object_num, int64_t pair_num) {
+    if (object_num < 2 || pair_num < 0) return NULL;
+
+    int64_t (*pairs)[2] = malloc(sizeof(*pairs) * (size_t)pair_num);
+    if (pairs == NULL) return NULL;
+
+    random_pairs_64_fill(pairs, object_num, pair_num, RANDOM_PAIRS_DEFAULT_SEED, 0);
+
+    struct random_pairs_64 *res = malloc(sizeof(*res));
+    if (res == NULL) {
+        free(pairs);
+        return NULL;
+    }
+
+    res->pairs = pairs;
+    res->object_num = object_num;
+    res->pair_num = pair_num;
+
+    return res;
+}
+
+bool random_pairs_64_write(const struct random_pairs_64 *pairs, const char *path) {
+    return pair_file_write(path, pairs->object_num, pairs->pair_num, sizeof(int64_t), pairs->pairs);
+}
+
+void random_pairs_64_delete(struct random_pairs_64 *pairs) {
     if (pairs != NULL) {
         free(pairs->pairs);
         free(pairs);
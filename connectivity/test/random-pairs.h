@@ -1,11 +1,77 @@
 #ifndef HEADER_RANDOM_PAIRS_H
 #define HEADER_RANDOM_PAIRS_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+struct pair_file;
+
+// 未指定种子时使用的种子，使各次运行的输入对相同
+#define RANDOM_PAIRS_DEFAULT_SEED 0x436f6e6e65637421ULL
+
+#define RANDOM_PAIRS_GOLDEN_GAMMA 0x9e3779b97f4a7c15ULL
+
+// SplitMix64的混合函数
+static inline uint64_t random_pairs_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// 第index个输入对使用的随机数序列的初始状态
+static inline uint64_t random_pairs_stream(uint64_t seed, uint64_t index) {
+    return random_pairs_mix(seed + (index + 1) * RANDOM_PAIRS_GOLDEN_GAMMA);
+}
+
+static inline uint64_t random_pairs_next(uint64_t *state) {
+    *state += RANDOM_PAIRS_GOLDEN_GAMMA;
+    return random_pairs_mix(*state);
+}
+
+// 无偏地返回[0, range)中的随机数(Lemire的方法)，range必须大于0
+static inline uint64_t random_pairs_below(uint64_t *state, uint64_t range) {
+    unsigned __int128 m = (unsigned __int128)random_pairs_next(state) * range;
+    uint64_t low = (uint64_t)m;
+    if (low < range) {
+        uint64_t threshold = -range % range;
+        while (low < threshold) {
+            m = (unsigned __int128)random_pairs_next(state) * range;
+            low = (uint64_t)m;
+        }
+    }
+    return m >> 64;
+}
+
+// [0, 1)中的随机浮点数
+static inline double random_pairs_unit(uint64_t *state) {
+    return (random_pairs_next(state) >> 11) * 0x1.0p-53;
+}
+
+// 用种子seed生成pair_num个两个对象不同的均匀随机输入对，
+// 使用thread_num个线程(不大于0时使用全部CPU核)，结果只取决于种子，与线程数无关
+void random_pairs_fill(int (*pairs)[2], int object_num, int pair_num, uint64_t seed, int thread_num);
+void random_pairs_64_fill(int64_t (*pairs)[2], int64_t object_num, int64_t pair_num, uint64_t seed, int thread_num);
+
+// 由random_pairs_load载入时，pairs直接指向映射到内存的文件，file不为NULL
 struct random_pairs {
     int (*pairs)[2];
+    int object_num, pair_num;
+    struct pair_file *file;
 };
 
 struct random_pairs *random_pairs_new(int object_num, int pair_num);
+struct random_pairs *random_pairs_new_seeded(int object_num, int pair_num, uint64_t seed, int thread_num);
+struct random_pairs *random_pairs_load(const char *path);
+bool random_pairs_write(const struct random_pairs *pairs, const char *path);
 void random_pairs_delete(struct random_pairs *pairs);
 
+struct random_pairs_64 {
+    int64_t (*pairs)[2];
+    int64_t object_num, pair_num;
+};
+
+struct random_pairs_64 *random_pairs_64_new(int64_t object_num, int64_t pair_num);
+bool random_pairs_64_write(const struct random_pairs_64 *pairs, const char *path);
+void random_pairs_64_delete(struct random_pairs_64 *pairs);
+
 #endif // HEADER_RANDOM_PAIRS_H
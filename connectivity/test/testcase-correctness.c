@@ -1,5 +1,13 @@
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "connectivity.h"
+#include "uf-engine.h"
+#include "random-pairs.h"
+#include "workloads.h"
+#include "concurrent-runner.h"
 #include "testcase-correctness.h"
 
 // 正确性测试用例中对象的个数
@@ -115,6 +123,88 @@ START_TEST(correctness_test_w_qunion_pc_h) {
     w_qunion_pc_h_delete_storage(storage);
 } END_TEST
 
+// 测试Weighted-quick-union-with-path-compression-by-halving算法的批量处理结果与逐个处理的结果一致
+START_TEST(correctness_test_w_qunion_pc_h_batch) {
+    const int object_num = 10000, pair_num = 50001;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    unsigned char *bitmap = malloc((pair_num + 7) / 8);
+    ck_assert_ptr_nonnull(bitmap);
+
+    struct storage_with_tree_size *batch_storage = w_qunion_pc_h_new_storage(object_num);
+    struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(object_num);
+    ck_assert_ptr_nonnull(batch_storage);
+    ck_assert_ptr_nonnull(storage);
+
+    w_qunion_pc_h_process_batch(batch_storage, input->pairs, pair_num, bitmap);
+    for (int i = 0; i < pair_num; i++) {
+        bool is_new = w_qunion_pc_h_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]);
+        ck_assert_int_eq((bitmap[i / 8] >> (i % 8)) & 1, is_new);
+    }
+
+    w_qunion_pc_h_delete_storage(storage);
+    w_qunion_pc_h_delete_storage(batch_storage);
+    free(bitmap);
+    random_pairs_delete(input);
+} END_TEST
+
+// 逐个处理随机输入对，每一步都将连通分量的个数、大小和对象列表与直接扫描存储数组的结果比较
+static void check_w_qunion_components(struct storage_with_tree_size *(*new_storage)(size_t),
+                                      bool (*is_new_connection)(struct storage_with_tree_size *, int, int),
+                                      void (*delete_storage)(struct storage_with_tree_size *)) {
+    const int object_num = 200, pair_num = 300;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    struct storage_with_tree_size *storage = new_storage(object_num);
+    ck_assert_ptr_nonnull(storage);
+    int *roots = malloc(sizeof(*roots) * object_num);
+    int *members = malloc(sizeof(*members) * object_num);
+    char *seen = malloc(object_num);
+    ck_assert(roots != NULL && members != NULL && seen != NULL);
+
+    size_t component_num = object_num;
+    ck_assert_uint_eq(w_qunion_component_count(storage), component_num);
+    for (int i = 0; i < pair_num; i++) {
+        if (is_new_connection(storage, input->pairs[i][0], input->pairs[i][1])) component_num--;
+        ck_assert_uint_eq(w_qunion_component_count(storage), component_num);
+        if (i % 50 != 49) continue;
+
+        for (int p = 0; p < object_num; p++) {
+            int root;
+            for (root = p; root != storage->data[root]; root = storage->data[root]);
+            roots[p] = root;
+        }
+        for (int p = 0; p < object_num; p++) {
+            int expected_size = 0;
+            for (int q = 0; q < object_num; q++) expected_size += roots[q] == roots[p];
+            ck_assert_int_eq(w_qunion_component_size(storage, p), expected_size);
+
+            // 列出的对象应互不相同，且都与p在同一个连通分量中
+            ck_assert_int_eq(w_qunion_component_members(storage, p, members), expected_size);
+            ck_assert_int_eq(members[0], p);
+            memset(seen, 0, object_num);
+            for (int k = 0; k < expected_size; k++) {
+                ck_assert_int_eq(roots[members[k]], roots[p]);
+                ck_assert(!seen[members[k]]);
+                seen[members[k]] = 1;
+            }
+        }
+    }
+
+    free(seen);
+    free(members);
+    free(roots);
+    delete_storage(storage);
+    random_pairs_delete(input);
+}
+
+// 测试三种加权算法维护的连通分量信息
+START_TEST(correctness_test_w_qunion_components) {
+    check_w_qunion_components(w_qunion_new_storage, w_qunion_is_new_connection, w_qunion_delete_storage);
+    check_w_qunion_components(w_qunion_pc_new_storage, w_qunion_pc_is_new_connection, w_qunion_pc_delete_storage);
+    check_w_qunion_components(w_qunion_pc_h_new_storage, w_qunion_pc_h_is_new_connection, w_qunion_pc_h_delete_storage);
+} END_TEST
+
 // 测试Heighted-quick-union算法的正确性
 START_TEST(correctness_test_h_qunion) {
     struct storage_with_tree_height *storage = h_qunion_new_storage(g_object_num);
@@ -133,6 +223,905 @@ START_TEST(correctness_test_h_qunion) {
     h_qunion_delete_storage(storage);
 } END_TEST
 
+// 测试通用Union-find引擎各策略组合的正确性
+#define CORRECTNESS_TEST_UF(name, link, compress, layout) \
+START_TEST(correctness_test_uf_##name) { \
+    struct uf_storage *storage = uf_##name##_new_storage(g_object_num); \
+    ck_assert_ptr_nonnull(storage); \
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) { \
+        ck_assert(uf_##name##_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1])); \
+    } \
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) { \
+        ck_assert(uf_##name##_connected_readonly(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1])); \
+        ck_assert(uf_##name##_connected(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1])); \
+        ck_assert(!uf_##name##_is_new_connection(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1])); \
+    } \
+    uf_delete_storage(storage); \
+} END_TEST
+
+#define CORRECTNESS_TEST_UF_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(CORRECTNESS_TEST_UF, name, link, compress)
+
+UF_ENGINE_LIST(CORRECTNESS_TEST_UF_LAYOUTS)
+UF_BYTE_WEIGHT_ENGINE_LIST(CORRECTNESS_TEST_UF)
+
+#undef CORRECTNESS_TEST_UF_LAYOUTS
+#undef CORRECTNESS_TEST_UF
+
+// 测试Concurrent-quick-union算法在单线程下的正确性
+START_TEST(correctness_test_c_qunion) {
+    struct concurrent_storage *storage = c_qunion_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    // 输入代表新连接的输入对
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) {
+        // 此处Concurrent-quick-union算法应将所有输入对判断为新连接
+        ck_assert(c_qunion_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+    }
+    // 输入代表旧连接的输入对
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) {
+        // connected操作和is_new_connection操作都应将所有输入对判断为旧连接
+        ck_assert(c_qunion_connected(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+        ck_assert(!c_qunion_is_new_connection(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+    }
+
+    c_qunion_delete_storage(storage);
+} END_TEST
+
+// 测试Concurrent-quick-union算法在多线程下的正确性
+START_TEST(correctness_test_c_qunion_threads) {
+    const int object_num = 100000, pair_num = 400000, thread_num = 8;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+
+    // 无论输入对的处理顺序如何，新连接的总数都等于对象数减去最终的集合数，
+    // 因此多线程报告的新连接总数必须与单线程算法的结果相同
+    struct storage_with_tree_size *expected_storage = w_qunion_pc_h_new_storage(object_num);
+    ck_assert_ptr_nonnull(expected_storage);
+    long long expected = 0;
+    for (int i = 0; i < pair_num; i++) {
+        if (w_qunion_pc_h_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1])) expected++;
+    }
+
+    struct concurrent_storage *storage = c_qunion_new_storage(object_num);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_int_eq(concurrent_run_pairs(storage, input->pairs, pair_num, thread_num), expected);
+    // 所有输入对都必须已连接
+    for (int i = 0; i < pair_num; i++) {
+        ck_assert(c_qunion_connected(storage, input->pairs[i][0], input->pairs[i][1]));
+    }
+
+    c_qunion_delete_storage(storage);
+    w_qunion_pc_h_delete_storage(expected_storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试Read-mostly-weighted-quick-union算法在单线程下的正确性
+START_TEST(correctness_test_rw_qunion) {
+    struct rw_storage *storage = rw_qunion_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    // 输入代表新连接的输入对
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) {
+        // 此处Read-mostly-weighted-quick-union算法应将所有输入对判断为新连接
+        ck_assert(!rw_qunion_connected(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+        ck_assert(rw_qunion_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+    }
+    // 输入代表旧连接的输入对
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) {
+        // connected操作和is_new_connection操作都应将所有输入对判断为旧连接
+        ck_assert(rw_qunion_connected(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+        ck_assert(!rw_qunion_is_new_connection(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+    }
+
+    rw_qunion_delete_storage(storage);
+} END_TEST
+
+// 测试Read-mostly-weighted-quick-union算法在一个写线程与多个读线程下的正确性
+START_TEST(correctness_test_rw_qunion_threads) {
+    const int object_num = 100000, pair_num = 400000, reader_num = 4;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+
+    struct storage_with_tree_size *expected_storage = w_qunion_pc_h_new_storage(object_num);
+    ck_assert_ptr_nonnull(expected_storage);
+    long long expected = 0;
+    for (int i = 0; i < pair_num; i++) {
+        if (w_qunion_pc_h_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1])) expected++;
+    }
+
+    // 写线程的结果与单线程算法相同，读线程从不把已处理的输入对判断为未连接
+    struct rw_storage *storage = rw_qunion_new_storage(object_num);
+    ck_assert_ptr_nonnull(storage);
+    long long query_num, missed_num;
+    ck_assert_int_eq(rw_run_pairs(storage, input->pairs, pair_num, reader_num, &query_num, &missed_num), expected);
+    ck_assert_int_eq(missed_num, 0);
+    for (int i = 0; i < pair_num; i++) {
+        ck_assert(rw_qunion_connected(storage, input->pairs[i][0], input->pairs[i][1]));
+    }
+
+    rw_qunion_delete_storage(storage);
+    w_qunion_pc_h_delete_storage(expected_storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试离线并行连通分量算法与Weighted-quick-union-with-path-compression-by-halving算法的结果一致，且与线程数无关
+START_TEST(correctness_test_p_cc) {
+    const int object_num = 100000, pair_num = 400000;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+
+    struct storage_with_tree_size *expected_storage = w_qunion_pc_h_new_storage(object_num);
+    ck_assert_ptr_nonnull(expected_storage);
+    for (int i = 0; i < pair_num; i++) w_qunion_pc_h_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1]);
+
+    struct cc_labels *single = p_cc_new_labels(input->pairs, pair_num, object_num, 1);
+    struct cc_labels *multiple = p_cc_new_labels(input->pairs, pair_num, object_num, 4);
+    ck_assert_ptr_nonnull(single);
+    ck_assert_ptr_nonnull(multiple);
+    ck_assert_uint_eq(single->component_num, expected_storage->component_num);
+    ck_assert_uint_eq(multiple->component_num, expected_storage->component_num);
+    // 标号是连通分量中序号最小的对象，因此与线程数无关
+    ck_assert_int_eq(memcmp(single->labels, multiple->labels, sizeof(int) * object_num), 0);
+    for (int i = 0; i < object_num; i++) {
+        ck_assert_int_le(multiple->labels[i], i);
+        ck_assert_int_eq(multiple->labels[multiple->labels[i]], multiple->labels[i]);
+        ck_assert_int_eq(w_qunion_pc_h_find(expected_storage, i) == w_qunion_pc_h_find(expected_storage, multiple->labels[i]), true);
+    }
+
+    // 没有输入对时每个对象自成一个连通分量
+    struct cc_labels *empty = p_cc_new_labels(input->pairs, 0, g_object_num, 0);
+    ck_assert_ptr_nonnull(empty);
+    ck_assert_uint_eq(empty->component_num, g_object_num);
+    for (int i = 0; i < g_object_num; i++) ck_assert_int_eq(empty->labels[i], i);
+
+    p_cc_delete_labels(empty);
+    p_cc_delete_labels(multiple);
+    p_cc_delete_labels(single);
+    w_qunion_pc_h_delete_storage(expected_storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试离线并行算法批量计算的新连接标志在各形态的输入下都与逐个处理输入对的算法完全相同
+START_TEST(correctness_test_p_cc_process_batch) {
+    // 输入对个数大于P_CC_WINDOW，需要多个窗口
+    const int object_num = 100000, pair_num = 300000;
+    unsigned char *expected = malloc((pair_num + 7) / 8);
+    unsigned char *single = malloc((pair_num + 7) / 8);
+    unsigned char *multiple = malloc((pair_num + 7) / 8);
+    ck_assert_ptr_nonnull(expected);
+    ck_assert_ptr_nonnull(single);
+    ck_assert_ptr_nonnull(multiple);
+    for (int w = 0; workload_name(w) != NULL; w++) {
+        struct random_pairs *input = workload_pairs_new(workload_name(w), object_num, pair_num, 42);
+        struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(object_num);
+        ck_assert_ptr_nonnull(input);
+        ck_assert_ptr_nonnull(storage);
+        w_qunion_pc_h_process_batch(storage, input->pairs, pair_num, expected);
+
+        ck_assert(p_cc_process_batch(input->pairs, pair_num, object_num, 1, single));
+        ck_assert(p_cc_process_batch(input->pairs, pair_num, object_num, 4, multiple));
+        ck_assert_msg(memcmp(expected, single, (pair_num + 7) / 8) == 0, "%s workload with 1 thread", workload_name(w));
+        ck_assert_msg(memcmp(expected, multiple, (pair_num + 7) / 8) == 0, "%s workload with 4 threads", workload_name(w));
+
+        w_qunion_pc_h_delete_storage(storage);
+        random_pairs_delete(input);
+    }
+    free(multiple);
+    free(single);
+    free(expected);
+} END_TEST
+
+// 测试Rollback-weighted-quick-union算法的正确性
+START_TEST(correctness_test_rb_qunion) {
+    struct rollback_storage *storage = rb_qunion_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    // 输入代表新连接的输入对
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) {
+        // 此处Rollback-weighted-quick-union算法应将所有输入对判断为新连接
+        ck_assert(rb_qunion_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+    }
+    // 输入代表旧连接的输入对
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) {
+        // 此处Rollback-weighted-quick-union算法应将所有输入对判断为旧连接
+        ck_assert(!rb_qunion_is_new_connection(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+    }
+    // 回滚到开头后，所有代表新连接的输入对重新成为新连接
+    ck_assert(rb_qunion_rollback(storage, 0));
+    ck_assert_uint_eq(storage->component_num, g_object_num);
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) {
+        ck_assert(rb_qunion_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+    }
+
+    rb_qunion_delete_storage(storage);
+} END_TEST
+
+// 测试Rollback-weighted-quick-union算法回滚后的存储结构与检查点时完全相同，且可以嵌套检查点
+START_TEST(correctness_test_rb_qunion_rollback) {
+    const int object_num = 10000, pair_num = 50000, base_num = pair_num / 2, batch_num = 10000;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    struct rollback_storage *storage = rb_qunion_new_storage(object_num);
+    struct storage_with_tree_size *expected_storage = w_qunion_new_storage(object_num);
+    int *data = malloc(sizeof(int) * object_num), *tree_size = malloc(sizeof(int) * object_num);
+    ck_assert_ptr_nonnull(input);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_ptr_nonnull(expected_storage);
+    ck_assert_ptr_nonnull(data);
+    ck_assert_ptr_nonnull(tree_size);
+
+    // 前一半输入对的结果与Weighted-quick-union算法相同
+    for (int i = 0; i < base_num; i++) {
+        ck_assert_int_eq(rb_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]),
+                         w_qunion_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1]));
+    }
+    ck_assert_uint_eq(storage->component_num, expected_storage->component_num);
+    memcpy(data, storage->data, sizeof(int) * object_num);
+    memcpy(tree_size, storage->tree_size, sizeof(int) * object_num);
+    size_t component_num = storage->component_num;
+
+    // 试探性地连接一批输入对，中间再设一个检查点
+    size_t checkpoint = rb_qunion_checkpoint(storage);
+    for (int i = base_num; i < base_num + batch_num / 2; i++) rb_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]);
+    size_t inner_checkpoint = rb_qunion_checkpoint(storage);
+    size_t inner_component_num = storage->component_num;
+    bool is_new[batch_num / 2];
+    for (int i = base_num + batch_num / 2; i < base_num + batch_num; i++) {
+        is_new[i - base_num - batch_num / 2] = rb_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]);
+    }
+    ck_assert_uint_lt(storage->component_num, inner_component_num);
+
+    // 回滚到内层检查点后，后半批输入对的判断与第一次相同
+    ck_assert(rb_qunion_rollback(storage, inner_checkpoint));
+    ck_assert_uint_eq(storage->component_num, inner_component_num);
+    for (int i = base_num + batch_num / 2; i < base_num + batch_num; i++) {
+        ck_assert_int_eq(rb_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]),
+                         is_new[i - base_num - batch_num / 2]);
+    }
+
+    // 回滚到外层检查点后，存储结构与检查点时完全相同，内层检查点不再有效
+    ck_assert(rb_qunion_rollback(storage, checkpoint));
+    ck_assert_uint_eq(storage->component_num, component_num);
+    ck_assert_int_eq(memcmp(data, storage->data, sizeof(int) * object_num), 0);
+    ck_assert_int_eq(memcmp(tree_size, storage->tree_size, sizeof(int) * object_num), 0);
+    ck_assert(!rb_qunion_rollback(storage, inner_checkpoint));
+
+    // 回滚之后继续处理的结果仍与Weighted-quick-union算法相同
+    for (int i = base_num; i < pair_num; i++) {
+        ck_assert_int_eq(rb_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]),
+                         w_qunion_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1]));
+    }
+
+    free(tree_size);
+    free(data);
+    w_qunion_delete_storage(expected_storage);
+    rb_qunion_delete_storage(storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试离线动态连通性算法的查询结果与每次查询时用剩余的连接重新建立存储结构的结果相同
+START_TEST(correctness_test_od_process_batch) {
+    const int object_num = 30, operation_num = 3000;
+    struct dynamic_operation *operations = malloc(sizeof(*operations) * operation_num);
+    int (*live)[2] = malloc(sizeof(*live) * operation_num);
+    unsigned char *bitmap = malloc((operation_num + 7) / 8);
+    ck_assert_ptr_nonnull(operations);
+    ck_assert_ptr_nonnull(live);
+    ck_assert_ptr_nonnull(bitmap);
+
+    uint64_t state = 42;
+    int live_num = 0;
+    for (int i = 0; i < operation_num; i++) {
+        int kind = random_pairs_below(&state, 10);
+        int p = random_pairs_below(&state, object_num), q = random_pairs_below(&state, object_num);
+        if (kind < 4) {
+            operations[i] = (struct dynamic_operation){DYNAMIC_INSERT, p, q};
+        } else if (kind < 7 && live_num > 0) {
+            // 删除一个存在的连接，对象的顺序可以与插入时相反
+            int k = random_pairs_below(&state, live_num);
+            operations[i] = (struct dynamic_operation){DYNAMIC_DELETE, live[k][1], live[k][0]};
+        } else if (kind < 7) {
+            // 删除不存在的连接不产生任何效果
+            operations[i] = (struct dynamic_operation){DYNAMIC_DELETE, p, q};
+        } else {
+            operations[i] = (struct dynamic_operation){DYNAMIC_QUERY, p, q};
+        }
+
+        if (operations[i].type == DYNAMIC_INSERT) {
+            live[live_num][0] = p;
+            live[live_num++][1] = q;
+        } else if (operations[i].type == DYNAMIC_DELETE) {
+            for (int k = 0; k < live_num; k++) {
+                if ((live[k][0] == operations[i].p && live[k][1] == operations[i].q)
+                    || (live[k][0] == operations[i].q && live[k][1] == operations[i].p)) {
+                    live[k][0] = live[--live_num][0];
+                    live[k][1] = live[live_num][1];
+                    break;
+                }
+            }
+        }
+    }
+    ck_assert(od_process_batch(operations, operation_num, object_num, bitmap));
+
+    // 重放操作序列，每次查询时用当时存在的连接重新建立存储结构
+    live_num = 0;
+    for (int i = 0; i < operation_num; i++) {
+        const struct dynamic_operation *operation = &operations[i];
+        if (operation->type == DYNAMIC_INSERT) {
+            live[live_num][0] = operation->p;
+            live[live_num++][1] = operation->q;
+            ck_assert_int_eq((bitmap[i / 8] >> (i % 8)) & 1, 0);
+        } else if (operation->type == DYNAMIC_DELETE) {
+            for (int k = 0; k < live_num; k++) {
+                if ((live[k][0] == operation->p && live[k][1] == operation->q)
+                    || (live[k][0] == operation->q && live[k][1] == operation->p)) {
+                    live[k][0] = live[--live_num][0];
+                    live[k][1] = live[live_num][1];
+                    break;
+                }
+            }
+            ck_assert_int_eq((bitmap[i / 8] >> (i % 8)) & 1, 0);
+        } else {
+            struct storage_with_tree_size *storage = w_qunion_new_storage(object_num);
+            ck_assert_ptr_nonnull(storage);
+            for (int k = 0; k < live_num; k++) w_qunion_is_new_connection(storage, live[k][0], live[k][1]);
+            ck_assert_int_eq((bitmap[i / 8] >> (i % 8)) & 1, w_qunion_connected(storage, operation->p, operation->q));
+            w_qunion_delete_storage(storage);
+        }
+    }
+
+    // 没有查询时什么也不做
+    ck_assert(od_process_batch(operations, 1, object_num, bitmap));
+
+    free(bitmap);
+    free(live);
+    free(operations);
+} END_TEST
+
+// 测试Versioned-weighted-quick-union算法的历史查询结果与重放前若干个输入对的结果相同
+START_TEST(correctness_test_vr_qunion) {
+    const int object_num = 200, pair_num = 1000, query_num = 300;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    struct versioned_storage *storage = vr_qunion_new_storage(object_num);
+    struct storage_with_tree_size *expected_storage = w_qunion_new_storage(object_num);
+    int (*queries)[2] = malloc(sizeof(*queries) * query_num);
+    size_t *since = malloc(sizeof(*since) * query_num);
+    ck_assert_ptr_nonnull(input);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_ptr_nonnull(expected_storage);
+    ck_assert_ptr_nonnull(queries);
+    ck_assert_ptr_nonnull(since);
+
+    for (int i = 0; i < pair_num; i++) {
+        ck_assert_int_eq(vr_qunion_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]),
+                         w_qunion_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1]));
+    }
+    ck_assert_uint_eq(vr_qunion_version(storage), pair_num);
+    w_qunion_delete_storage(expected_storage);
+    expected_storage = w_qunion_new_storage(object_num);
+    ck_assert_ptr_nonnull(expected_storage);
+
+    // 查询的对象对中包括相同的对象
+    uint64_t state = 42;
+    for (int k = 0; k < query_num; k++) {
+        queries[k][0] = random_pairs_below(&state, object_num);
+        queries[k][1] = k % 50 == 0 ? queries[k][0] : (int)random_pairs_below(&state, object_num);
+        since[k] = VR_QUNION_NEVER;
+    }
+
+    // 重放输入对，每个版本都与重放的结果比较，并记录每对对象第一次连接的版本
+    for (int v = 0; v <= pair_num; v++) {
+        if (v > 0) w_qunion_is_new_connection(expected_storage, input->pairs[v - 1][0], input->pairs[v - 1][1]);
+        for (int k = 0; k < query_num; k++) {
+            bool connected = w_qunion_connected(expected_storage, queries[k][0], queries[k][1]);
+            ck_assert_int_eq(vr_qunion_connected_at(storage, queries[k][0], queries[k][1], v), connected);
+            if (connected && since[k] == VR_QUNION_NEVER) since[k] = v;
+        }
+    }
+    for (int k = 0; k < query_num; k++) {
+        ck_assert_uint_eq(vr_qunion_connected_since(storage, queries[k][0], queries[k][1]), since[k]);
+        ck_assert_int_eq(vr_qunion_connected(storage, queries[k][0], queries[k][1]), since[k] != VR_QUNION_NEVER);
+        // 超过当前版本的查询与当前版本相同
+        ck_assert_int_eq(vr_qunion_connected_at(storage, queries[k][0], queries[k][1], VR_QUNION_NEVER),
+                         since[k] != VR_QUNION_NEVER);
+    }
+
+    free(since);
+    free(queries);
+    w_qunion_delete_storage(expected_storage);
+    vr_qunion_delete_storage(storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试64位序号的Weighted-quick-union算法的正确性
+#define CORRECTNESS_TEST_64(name, layout) \
+START_TEST(correctness_test_##name##_##layout) { \
+    struct storage_64 *storage = name##_new_storage(g_object_num, layout); \
+    ck_assert_ptr_nonnull(storage); \
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) { \
+        ck_assert(name##_is_new_connection(storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1])); \
+    } \
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) { \
+        ck_assert(!name##_is_new_connection(storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1])); \
+    } \
+    name##_delete_storage(storage); \
+} END_TEST
+
+CORRECTNESS_TEST_64(w_qunion_64, STORAGE_64_WIDE)
+CORRECTNESS_TEST_64(w_qunion_64, STORAGE_64_PACKED40)
+CORRECTNESS_TEST_64(w_qunion_pc_h_64, STORAGE_64_WIDE)
+CORRECTNESS_TEST_64(w_qunion_pc_h_64, STORAGE_64_PACKED40)
+
+#undef CORRECTNESS_TEST_64
+
+// 测试64位序号的算法在随机输入下与int版本的结果一致
+START_TEST(correctness_test_w_qunion_pc_h_64_random) {
+    const int object_num = 10000, pair_num = 50000;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(object_num);
+    struct storage_64 *wide_storage = w_qunion_pc_h_64_new_storage(object_num, STORAGE_64_WIDE);
+    struct storage_64 *packed_storage = w_qunion_pc_h_64_new_storage(object_num, STORAGE_64_PACKED40);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_ptr_nonnull(wide_storage);
+    ck_assert_ptr_nonnull(packed_storage);
+
+    for (int i = 0; i < pair_num; i++) {
+        bool is_new = w_qunion_pc_h_is_new_connection(storage, input->pairs[i][0], input->pairs[i][1]);
+        ck_assert_int_eq(w_qunion_pc_h_64_is_new_connection(wide_storage, input->pairs[i][0], input->pairs[i][1]), is_new);
+        ck_assert_int_eq(w_qunion_pc_h_64_is_new_connection(packed_storage, input->pairs[i][0], input->pairs[i][1]), is_new);
+    }
+
+    w_qunion_pc_h_64_delete_storage(packed_storage);
+    w_qunion_pc_h_64_delete_storage(wide_storage);
+    w_qunion_pc_h_delete_storage(storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试映射到文件的存储在关闭后重新打开时能保留连接信息
+START_TEST(correctness_test_mmap_storage) {
+    char path[] = "/tmp/connectivity-mmap-XXXXXX";
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+
+    struct mmap_storage *storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    // 输入代表新连接的输入对
+    for (int i = 0; i < sizeof(g_new_connection_pairs)/sizeof(g_new_connection_pairs[0]); i++) {
+        ck_assert(w_qunion_pc_h_is_new_connection(&storage->storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]));
+    }
+    ck_assert_uint_eq(w_qunion_component_count(&storage->storage), 1);
+    ck_assert(mmap_storage_sync(storage));
+    mmap_storage_close(storage);
+
+    // 算法或对象个数与文件头不符时，拒绝打开
+    ck_assert_ptr_null(mmap_storage_open(path, MMAP_STORAGE_W_QUNION, g_object_num));
+    ck_assert_ptr_null(mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num + 1));
+
+    // 重新打开后，代表旧连接的输入对应被判断为旧连接
+    storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_uint_eq(w_qunion_component_count(&storage->storage), 1);
+    ck_assert_int_eq(w_qunion_component_size(&storage->storage, 0), g_object_num);
+    for (int i = 0; i < sizeof(g_old_connection_pairs)/sizeof(g_old_connection_pairs[0]); i++) {
+        ck_assert(!w_qunion_pc_h_is_new_connection(&storage->storage, g_old_connection_pairs[i][0], g_old_connection_pairs[i][1]));
+    }
+    mmap_storage_close(storage);
+
+    // 进程没有同步或关闭就退出时，重新打开后应重新统计连通分量的个数
+    unlink(path);
+    pid_t pid = fork();
+    ck_assert_int_ge(pid, 0);
+    if (pid == 0) {
+        storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+        if (storage == NULL) _exit(1);
+        for (int i = 0; i < 3; i++) {
+            w_qunion_pc_h_is_new_connection(&storage->storage, g_new_connection_pairs[i][0], g_new_connection_pairs[i][1]);
+        }
+        _exit(0);
+    }
+    int status;
+    ck_assert_int_eq(waitpid(pid, &status, 0), pid);
+    ck_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_uint_eq(w_qunion_component_count(&storage->storage), g_object_num - 3);
+    mmap_storage_close(storage);
+
+    unlink(path);
+} END_TEST
+
+// 将连续的序号打散为分布在整个64位范围内的键
+static uint64_t correctness_scatter_key(int i) {
+    return (uint64_t)i * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL;
+}
+
+// 测试Keyed-quick-union算法在随机输入下与Weighted-quick-union-with-path-compression-by-halving算法的结果一致
+START_TEST(correctness_test_k_qunion) {
+    const int object_num = 10000, pair_num = 50000;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    struct storage_with_tree_size *expected_storage = w_qunion_pc_h_new_storage(object_num);
+    // 预估的键的个数远小于实际个数，使哈希表和引擎的存储都要多次扩容
+    struct keyed_storage *storage = k_qunion_new_storage(1);
+    struct keyed_storage *batch_storage = k_qunion_new_storage(1);
+    ck_assert_ptr_nonnull(expected_storage);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_ptr_nonnull(batch_storage);
+
+    uint64_t (*keys)[2] = malloc(sizeof(*keys) * pair_num);
+    unsigned char *bitmap = malloc((pair_num + 7) / 8);
+    ck_assert_ptr_nonnull(keys);
+    ck_assert_ptr_nonnull(bitmap);
+    for (int i = 0; i < pair_num; i++) {
+        keys[i][0] = correctness_scatter_key(input->pairs[i][0]);
+        keys[i][1] = correctness_scatter_key(input->pairs[i][1]);
+    }
+    k_qunion_process_batch(batch_storage, keys, pair_num, bitmap);
+
+    for (int i = 0; i < pair_num; i++) {
+        bool is_new = w_qunion_pc_h_is_new_connection(expected_storage, input->pairs[i][0], input->pairs[i][1]);
+        ck_assert_int_eq(k_qunion_is_new_connection(storage, keys[i][0], keys[i][1]), is_new);
+        ck_assert_int_eq((bitmap[i / 8] >> (i % 8)) & 1, is_new);
+    }
+    ck_assert_uint_eq(storage->key_num, batch_storage->key_num);
+
+    // 已出现的键总是映射到同一个序号，批量查找与逐个查找的结果相同
+    int indices[64];
+    uint64_t lookup_keys[64];
+    for (int i = 0; i < 64; i++) lookup_keys[i] = keys[i][0];
+    size_t key_num = storage->key_num;
+    k_qunion_index_batch(storage, lookup_keys, 64, indices);
+    for (int i = 0; i < 64; i++) ck_assert_int_eq(k_qunion_index(storage, lookup_keys[i]), indices[i]);
+    ck_assert_uint_eq(storage->key_num, key_num);
+
+    free(bitmap);
+    free(keys);
+    k_qunion_delete_storage(batch_storage);
+    k_qunion_delete_storage(storage);
+    w_qunion_pc_h_delete_storage(expected_storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试各算法的查询操作与Quick-find算法的结果一致，且查询不会连接任何对象，*_readonly版本不修改存储结构
+START_TEST(correctness_test_find_connected) {
+    const int object_num = 2000, pair_num = 3000, processed_num = pair_num / 2;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    int *expected_storage = qfind_new_storage(object_num);
+    int *q_storage = qunion_new_storage(object_num);
+    struct storage_with_tree_size *w_storage = w_qunion_new_storage(object_num);
+    struct storage_with_tree_size *pc_storage = w_qunion_pc_new_storage(object_num);
+    struct storage_with_tree_size *pc_h_storage = w_qunion_pc_h_new_storage(object_num);
+    struct storage_with_tree_height *h_storage = h_qunion_new_storage(object_num);
+    struct concurrent_storage *c_storage = c_qunion_new_storage(object_num);
+    struct storage_64 *storage_64 = w_qunion_pc_h_64_new_storage(object_num, STORAGE_64_WIDE);
+    struct uf_storage *uf_storage = uf_w_qunion_pc_s_new_storage(object_num);
+    struct keyed_storage *k_storage = k_qunion_new_storage(object_num);
+    int *snapshot = malloc(sizeof(int) * object_num);
+    ck_assert_ptr_nonnull(expected_storage);
+    ck_assert_ptr_nonnull(q_storage);
+    ck_assert_ptr_nonnull(w_storage);
+    ck_assert_ptr_nonnull(pc_storage);
+    ck_assert_ptr_nonnull(pc_h_storage);
+    ck_assert_ptr_nonnull(h_storage);
+    ck_assert_ptr_nonnull(c_storage);
+    ck_assert_ptr_nonnull(storage_64);
+    ck_assert_ptr_nonnull(uf_storage);
+    ck_assert_ptr_nonnull(k_storage);
+    ck_assert_ptr_nonnull(snapshot);
+
+    // 只处理前一半输入对，后一半输入对中既有已连接的也有未连接的
+    for (int i = 0; i < processed_num; i++) {
+        int p = input->pairs[i][0], q = input->pairs[i][1];
+        qfind_is_new_connection(expected_storage, object_num, p, q);
+        qunion_is_new_connection(q_storage, p, q);
+        w_qunion_is_new_connection(w_storage, p, q);
+        w_qunion_pc_is_new_connection(pc_storage, p, q);
+        w_qunion_pc_h_is_new_connection(pc_h_storage, p, q);
+        h_qunion_is_new_connection(h_storage, p, q);
+        c_qunion_is_new_connection(c_storage, p, q);
+        w_qunion_pc_h_64_is_new_connection(storage_64, p, q);
+        uf_w_qunion_pc_s_is_new_connection(uf_storage, p, q);
+        k_qunion_is_new_connection(k_storage, correctness_scatter_key(p), correctness_scatter_key(q));
+    }
+
+    // *_readonly版本不修改存储结构
+    memcpy(snapshot, pc_storage->data, sizeof(int) * object_num);
+    for (int i = 0; i < pair_num; i++) {
+        int p = input->pairs[i][0], q = input->pairs[i][1];
+        ck_assert_int_eq(w_qunion_pc_connected_readonly(pc_storage, p, q), qfind_connected(expected_storage, p, q));
+    }
+    ck_assert_int_eq(memcmp(snapshot, pc_storage->data, sizeof(int) * object_num), 0);
+    memcpy(snapshot, pc_h_storage->data, sizeof(int) * object_num);
+    for (int i = 0; i < pair_num; i++) {
+        int p = input->pairs[i][0], q = input->pairs[i][1];
+        ck_assert_int_eq(w_qunion_pc_h_connected_readonly(pc_h_storage, p, q), qfind_connected(expected_storage, p, q));
+    }
+    ck_assert_int_eq(memcmp(snapshot, pc_h_storage->data, sizeof(int) * object_num), 0);
+
+    for (int i = 0; i < pair_num; i++) {
+        int p = input->pairs[i][0], q = input->pairs[i][1];
+        bool expected = qfind_connected(expected_storage, p, q);
+        ck_assert_int_eq(qfind_find(expected_storage, p) == qfind_find(expected_storage, q), expected);
+        ck_assert_int_eq(qunion_connected(q_storage, p, q), expected);
+        ck_assert_int_eq(qunion_find(q_storage, p) == qunion_find(q_storage, q), expected);
+        ck_assert_int_eq(w_qunion_connected(w_storage, p, q), expected);
+        ck_assert_int_eq(w_qunion_find(w_storage, p) == w_qunion_find(w_storage, q), expected);
+        ck_assert_int_eq(w_qunion_pc_connected(pc_storage, p, q), expected);
+        ck_assert_int_eq(w_qunion_pc_find(pc_storage, p) == w_qunion_pc_find(pc_storage, q), expected);
+        ck_assert_int_eq(w_qunion_pc_find_readonly(pc_storage, p) == w_qunion_pc_find_readonly(pc_storage, q), expected);
+        ck_assert_int_eq(w_qunion_pc_h_connected(pc_h_storage, p, q), expected);
+        ck_assert_int_eq(w_qunion_pc_h_find(pc_h_storage, p) == w_qunion_pc_h_find(pc_h_storage, q), expected);
+        ck_assert_int_eq(w_qunion_pc_h_find_readonly(pc_h_storage, p) == w_qunion_pc_h_find_readonly(pc_h_storage, q), expected);
+        ck_assert_int_eq(h_qunion_connected(h_storage, p, q), expected);
+        ck_assert_int_eq(h_qunion_find(h_storage, p) == h_qunion_find(h_storage, q), expected);
+        ck_assert_int_eq(c_qunion_connected(c_storage, p, q), expected);
+        ck_assert_int_eq(c_qunion_connected_readonly(c_storage, p, q), expected);
+        ck_assert_int_eq(c_qunion_find(c_storage, p) == c_qunion_find(c_storage, q), expected);
+        ck_assert_int_eq(w_qunion_pc_h_64_connected(storage_64, p, q), expected);
+        ck_assert_int_eq(w_qunion_pc_h_64_connected_readonly(storage_64, p, q), expected);
+        ck_assert_int_eq(uf_w_qunion_pc_s_connected(uf_storage, p, q), expected);
+        ck_assert_int_eq(uf_w_qunion_pc_s_connected_readonly(uf_storage, p, q), expected);
+        uint64_t pkey = correctness_scatter_key(p), qkey = correctness_scatter_key(q);
+        ck_assert_int_eq(k_qunion_connected(k_storage, pkey, qkey), expected);
+        ck_assert_int_eq(k_qunion_connected_readonly(k_storage, pkey, qkey), expected);
+    }
+
+    // 查询不会连接任何对象: 此后处理后一半输入对，新连接的判断仍与Quick-find算法相同
+    for (int i = processed_num; i < pair_num; i++) {
+        int p = input->pairs[i][0], q = input->pairs[i][1];
+        bool is_new = qfind_is_new_connection(expected_storage, object_num, p, q);
+        ck_assert_int_eq(w_qunion_pc_is_new_connection(pc_storage, p, q), is_new);
+        ck_assert_int_eq(c_qunion_is_new_connection(c_storage, p, q), is_new);
+        ck_assert_int_eq(uf_w_qunion_pc_s_is_new_connection(uf_storage, p, q), is_new);
+    }
+
+    // 从未出现过的键只与自身相连，且查询不会为它分配序号
+    size_t key_num = k_storage->key_num;
+    uint64_t unknown_key = correctness_scatter_key(object_num);
+    ck_assert_int_eq(k_qunion_find(k_storage, unknown_key), -1);
+    ck_assert(k_qunion_connected(k_storage, unknown_key, unknown_key));
+    ck_assert(!k_qunion_connected(k_storage, unknown_key, correctness_scatter_key(input->pairs[0][0])));
+    ck_assert_uint_eq(k_storage->key_num, key_num);
+
+    free(snapshot);
+    k_qunion_delete_storage(k_storage);
+    uf_delete_storage(uf_storage);
+    w_qunion_pc_h_64_delete_storage(storage_64);
+    c_qunion_delete_storage(c_storage);
+    h_qunion_delete_storage(h_storage);
+    w_qunion_pc_h_delete_storage(pc_h_storage);
+    w_qunion_pc_delete_storage(pc_storage);
+    w_qunion_delete_storage(w_storage);
+    qunion_delete_storage(q_storage);
+    qfind_delete_storage(expected_storage);
+    random_pairs_delete(input);
+} END_TEST
+
+// 测试输入对文件写出后重新载入的内容不变
+START_TEST(correctness_test_pair_file) {
+    char path[] = "/tmp/connectivity-pairs-XXXXXX";
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+
+    const int object_num = 1000, pair_num = 5000;
+    struct random_pairs *input = random_pairs_new(object_num, pair_num);
+    ck_assert_ptr_nonnull(input);
+    ck_assert(random_pairs_write(input, path));
+
+    struct random_pairs *loaded = random_pairs_load(path);
+    ck_assert_ptr_nonnull(loaded);
+    ck_assert_int_eq(loaded->object_num, object_num);
+    ck_assert_int_eq(loaded->pair_num, pair_num);
+    ck_assert(pair_file_validate(loaded->file));
+    for (int i = 0; i < pair_num; i++) {
+        ck_assert_int_eq(loaded->pairs[i][0], input->pairs[i][0]);
+        ck_assert_int_eq(loaded->pairs[i][1], input->pairs[i][1]);
+    }
+    random_pairs_delete(loaded);
+
+    // 对象个数小于实际的序号时，pair_file_validate应报告错误
+    ck_assert(pair_file_write(path, 10, pair_num, sizeof(int), input->pairs));
+    struct pair_file *file = pair_file_open(path);
+    ck_assert_ptr_nonnull(file);
+    ck_assert(!pair_file_validate(file));
+    pair_file_close(file);
+
+    // 截断的文件应被拒绝
+    ck_assert_int_eq(truncate(path, 64 + sizeof(int[2]) * pair_num - 1), 0);
+    ck_assert_ptr_null(pair_file_open(path));
+
+    random_pairs_delete(input);
+    unlink(path);
+} END_TEST
+
+// 测试字节顺序与本机不同的输入对文件在载入时被正确转换
+START_TEST(correctness_test_pair_file_swapped) {
+    char path[] = "/tmp/connectivity-pairs-XXXXXX";
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+
+    int64_t pairs[3][2] = {{0, 1}, {2, 3}, {1234567890123LL, 4}};
+    ck_assert(pair_file_write(path, 1234567890124LL, 3, sizeof(int64_t), pairs));
+
+    // 把文件头的各字段和所有序号的字节顺序反转，并修改字节顺序标记
+    unsigned char bytes[64 + sizeof(pairs)];
+    fd = open(path, O_RDWR);
+    ck_assert_int_eq(read(fd, bytes, sizeof(bytes)), sizeof(bytes));
+    uint32_t version;
+    memcpy(&version, bytes + 8, sizeof(version));
+    version = __builtin_bswap32(version);
+    memcpy(bytes + 8, &version, sizeof(version));
+    bytes[13] = bytes[13] == 1 ? 2 : 1;
+    for (int offset = 16; offset < sizeof(bytes); offset += 8) {
+        // 跳过文件头中保留的字节
+        if (offset >= 40 && offset < 64) continue;
+        uint64_t value;
+        memcpy(&value, bytes + offset, sizeof(value));
+        value = __builtin_bswap64(value);
+        memcpy(bytes + offset, &value, sizeof(value));
+    }
+    ck_assert_int_eq(pwrite(fd, bytes, sizeof(bytes), 0), sizeof(bytes));
+    close(fd);
+
+    struct pair_file *file = pair_file_open(path);
+    ck_assert_ptr_nonnull(file);
+    ck_assert_int_eq(file->index_width, 8);
+    ck_assert_int_eq(file->object_num, 1234567890124LL);
+    ck_assert_int_eq(file->pair_num, 3);
+    for (int i = 0; i < 3; i++) {
+        ck_assert_int_eq(file->pairs_64[i][0], pairs[i][0]);
+        ck_assert_int_eq(file->pairs_64[i][1], pairs[i][1]);
+    }
+    pair_file_close(file);
+
+    unlink(path);
+} END_TEST
+
+// 测试文本输入对的解析，包括跨调用的输入对、数组已满、奇数个整数以及各种错误的位置
+START_TEST(correctness_test_pair_text) {
+    int pairs[4][2];
+    struct pair_text_parser parser;
+    const char *stop;
+
+    // 各种空白字符都可以分隔整数，输入对可以跨越两次调用，最后一个整数没有配对
+    const char *first = "0 1\n2\t", *second = "3\r\n\v\f9";
+    pair_text_init(&parser, 10, pairs, 4);
+    ck_assert_int_eq(pair_text_parse(&parser, first, first + strlen(first), &stop), PAIR_TEXT_OK);
+    ck_assert_ptr_eq(stop, first + strlen(first));
+    ck_assert_int_eq(parser.pending, 2);
+    ck_assert_int_eq(pair_text_parse(&parser, second, second + strlen(second), &stop), PAIR_TEXT_OK);
+    ck_assert_uint_eq(parser.pair_len, 2);
+    ck_assert_int_eq(pairs[0][0], 0);
+    ck_assert_int_eq(pairs[0][1], 1);
+    ck_assert_int_eq(pairs[1][0], 2);
+    ck_assert_int_eq(pairs[1][1], 3);
+    ck_assert_int_eq(parser.pending, 9);
+    ck_assert_int_eq(parser.offset, strlen(first) + strlen(second));
+
+    // 数组已满时停在下一个未解析的字节，清零pair_len后可以继续
+    const char *text = "1 2 3 4 5 6";
+    pair_text_init(&parser, 10, pairs, 2);
+    ck_assert_int_eq(pair_text_parse(&parser, text, text + strlen(text), &stop), PAIR_TEXT_FULL);
+    ck_assert_ptr_eq(stop, text + 7);
+    parser.pair_len = 0;
+    ck_assert_int_eq(pair_text_parse(&parser, stop, text + strlen(text), &stop), PAIR_TEXT_OK);
+    ck_assert_uint_eq(parser.pair_len, 1);
+    ck_assert_int_eq(pairs[0][0], 5);
+    ck_assert_int_eq(pairs[0][1], 6);
+    ck_assert_int_eq(parser.pending, -1);
+
+    // 不小于object_num的整数，包括超出long long范围的数字串，位置为该整数的开头
+    const char *out_of_range[] = {"3 10", "3 99999999999999999999999999", "3 0010"};
+    for (int i = 0; i < sizeof(out_of_range) / sizeof(out_of_range[0]); i++) {
+        pair_text_init(&parser, 10, pairs, 4);
+        ck_assert_int_eq(pair_text_parse(&parser, out_of_range[i], out_of_range[i] + strlen(out_of_range[i]), &stop),
+                         PAIR_TEXT_OUT_OF_RANGE);
+        ck_assert_ptr_eq(stop, out_of_range[i] + 2);
+        ck_assert_int_eq(parser.offset, 2);
+    }
+    ck_assert_str_eq(pair_text_error(PAIR_TEXT_OUT_OF_RANGE), "object out of range");
+
+    // 负号和其他非数字、非空白的字符都是无效字符，位置计入此前调用解析过的字节
+    const char *prefix = "0 1 ", *invalid[] = {"-1", "2 x", "2 3,4"};
+    const long long invalid_offset[] = {4, 6, 7};
+    for (int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        pair_text_init(&parser, 10, pairs, 4);
+        ck_assert_int_eq(pair_text_parse(&parser, prefix, prefix + strlen(prefix), &stop), PAIR_TEXT_OK);
+        ck_assert_int_eq(pair_text_parse(&parser, invalid[i], invalid[i] + strlen(invalid[i]), &stop), PAIR_TEXT_INVALID_CHARACTER);
+        ck_assert_int_eq(parser.offset, invalid_offset[i]);
+    }
+    ck_assert_str_eq(pair_text_error(PAIR_TEXT_INVALID_CHARACTER), "invalid character");
+    ck_assert_ptr_null(pair_text_error(PAIR_TEXT_OK));
+} END_TEST
+
+// 测试随机输入对的生成结果只取决于种子，与线程数无关，且两个对象不同、分布均匀
+START_TEST(correctness_test_random_pairs) {
+    const int object_num = 10, pair_num = 1000000;
+    struct random_pairs *single = random_pairs_new_seeded(object_num, pair_num, 42, 1);
+    struct random_pairs *multiple = random_pairs_new_seeded(object_num, pair_num, 42, 4);
+    struct random_pairs *reseeded = random_pairs_new_seeded(object_num, pair_num, 43, 4);
+    ck_assert_ptr_nonnull(single);
+    ck_assert_ptr_nonnull(multiple);
+    ck_assert_ptr_nonnull(reseeded);
+    ck_assert_int_eq(memcmp(single->pairs, multiple->pairs, sizeof(int[2]) * pair_num), 0);
+    ck_assert_int_ne(memcmp(single->pairs, reseeded->pairs, sizeof(int[2]) * pair_num), 0);
+
+    int counts[2][10] = {{0}};
+    for (int i = 0; i < pair_num; i++) {
+        ck_assert_int_ne(single->pairs[i][0], single->pairs[i][1]);
+        ck_assert(single->pairs[i][0] >= 0 && single->pairs[i][0] < object_num);
+        ck_assert(single->pairs[i][1] >= 0 && single->pairs[i][1] < object_num);
+        counts[0][single->pairs[i][0]]++;
+        counts[1][single->pairs[i][1]]++;
+    }
+    // 每个对象出现的次数与期望值的偏差应在1%之内(约为标准差的3倍，种子固定，结果是确定的)
+    for (int i = 0; i < object_num; i++) {
+        ck_assert(abs(counts[0][i] - pair_num / object_num) < pair_num / object_num / 100);
+        ck_assert(abs(counts[1][i] - pair_num / object_num) < pair_num / object_num / 100);
+    }
+
+    random_pairs_delete(reseeded);
+    random_pairs_delete(multiple);
+    random_pairs_delete(single);
+} END_TEST
+
+// 测试各形态的输入对都在范围内、两个对象不同，且同一种子的结果相同
+START_TEST(correctness_test_workloads) {
+    const int object_num = 1000, pair_num = 5000;
+    for (int w = 0; workload_name(w) != NULL; w++) {
+        struct random_pairs *input = workload_pairs_new(workload_name(w), object_num, pair_num, 42);
+        struct random_pairs *again = workload_pairs_new(workload_name(w), object_num, pair_num, 42);
+        ck_assert_ptr_nonnull(input);
+        ck_assert_ptr_nonnull(again);
+        ck_assert_int_eq(memcmp(input->pairs, again->pairs, sizeof(int[2]) * pair_num), 0);
+        for (int i = 0; i < pair_num; i++) {
+            ck_assert(input->pairs[i][0] >= 0 && input->pairs[i][0] < object_num);
+            ck_assert(input->pairs[i][1] >= 0 && input->pairs[i][1] < object_num);
+            ck_assert_int_ne(input->pairs[i][0], input->pairs[i][1]);
+        }
+        random_pairs_delete(again);
+        random_pairs_delete(input);
+    }
+    ck_assert_ptr_null(workload_pairs_new("unknown", object_num, pair_num, 42));
+} END_TEST
+
+// 测试最坏情况的输入对确实使树达到预期的高度
+START_TEST(correctness_test_workloads_worst_case) {
+    const int object_num = 1024;
+    // chain: 前N-1个输入对全是新连接，Quick-union算法中对象0的深度为N-1
+    struct random_pairs *chain = workload_pairs_new("chain", object_num, object_num - 1, 42);
+    ck_assert_ptr_nonnull(chain);
+    int *qunion_storage = qunion_new_storage(object_num);
+    ck_assert_ptr_nonnull(qunion_storage);
+    for (int i = 0; i < object_num - 1; i++) {
+        ck_assert(qunion_is_new_connection(qunion_storage, chain->pairs[i][0], chain->pairs[i][1]));
+    }
+    int depth = 0;
+    for (int i = 0; i != qunion_storage[i]; i = qunion_storage[i]) depth++;
+    ck_assert_int_eq(depth, object_num - 1);
+    qunion_delete_storage(qunion_storage);
+    random_pairs_delete(chain);
+
+    // binomial: 前N-1个输入对全是新连接，Weighted-quick-union算法中树的高度为lgN
+    struct random_pairs *binomial = workload_pairs_new("binomial", object_num, object_num - 1, 42);
+    ck_assert_ptr_nonnull(binomial);
+    struct storage_with_tree_size *storage = w_qunion_new_storage(object_num);
+    ck_assert_ptr_nonnull(storage);
+    for (int i = 0; i < object_num - 1; i++) {
+        ck_assert(w_qunion_is_new_connection(storage, binomial->pairs[i][0], binomial->pairs[i][1]));
+    }
+    int max_depth = 0;
+    for (int p = 0; p < object_num; p++) {
+        depth = 0;
+        for (int i = p; i != storage->data[i]; i = storage->data[i]) depth++;
+        if (depth > max_depth) max_depth = depth;
+    }
+    ck_assert_int_eq(max_depth, 10);
+    w_qunion_delete_storage(storage);
+    random_pairs_delete(binomial);
+} END_TEST
+
 void suite_add_testcase_correctness(Suite *s) {
     TCase *tc_correct = tcase_create("Correctness Testcase");
     tcase_add_test(tc_correct, correctness_test_qfind);
@@ -140,7 +1129,39 @@ void suite_add_testcase_correctness(Suite *s) {
     tcase_add_test(tc_correct, correctness_test_w_qunion);
     tcase_add_test(tc_correct, correctness_test_w_qunion_pc);
     tcase_add_test(tc_correct, correctness_test_w_qunion_pc_h);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_pc_h_batch);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_components);
     tcase_add_test(tc_correct, correctness_test_h_qunion);
+    tcase_add_test(tc_correct, correctness_test_c_qunion);
+    tcase_add_test(tc_correct, correctness_test_c_qunion_threads);
+    tcase_add_test(tc_correct, correctness_test_rw_qunion);
+    tcase_add_test(tc_correct, correctness_test_rw_qunion_threads);
+    tcase_add_test(tc_correct, correctness_test_p_cc);
+    tcase_add_test(tc_correct, correctness_test_p_cc_process_batch);
+    tcase_add_test(tc_correct, correctness_test_rb_qunion);
+    tcase_add_test(tc_correct, correctness_test_rb_qunion_rollback);
+    tcase_add_test(tc_correct, correctness_test_od_process_batch);
+    tcase_add_test(tc_correct, correctness_test_vr_qunion);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_64_STORAGE_64_WIDE);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_64_STORAGE_64_PACKED40);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_pc_h_64_STORAGE_64_WIDE);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_pc_h_64_STORAGE_64_PACKED40);
+    tcase_add_test(tc_correct, correctness_test_w_qunion_pc_h_64_random);
+    tcase_add_test(tc_correct, correctness_test_mmap_storage);
+    tcase_add_test(tc_correct, correctness_test_k_qunion);
+    tcase_add_test(tc_correct, correctness_test_find_connected);
+    tcase_add_test(tc_correct, correctness_test_pair_file);
+    tcase_add_test(tc_correct, correctness_test_pair_file_swapped);
+    tcase_add_test(tc_correct, correctness_test_pair_text);
+    tcase_add_test(tc_correct, correctness_test_random_pairs);
+    tcase_add_test(tc_correct, correctness_test_workloads);
+    tcase_add_test(tc_correct, correctness_test_workloads_worst_case);
+#define ADD_CORRECTNESS_TEST_UF(name, link, compress, layout) tcase_add_test(tc_correct, correctness_test_uf_##name);
+#define ADD_CORRECTNESS_TEST_UF_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(ADD_CORRECTNESS_TEST_UF, name, link, compress)
+    UF_ENGINE_LIST(ADD_CORRECTNESS_TEST_UF_LAYOUTS)
+    UF_BYTE_WEIGHT_ENGINE_LIST(ADD_CORRECTNESS_TEST_UF)
+#undef ADD_CORRECTNESS_TEST_UF_LAYOUTS
+#undef ADD_CORRECTNESS_TEST_UF
     suite_add_tcase(s, tc_correct);
     return;
 }
@@ -1,9 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <stdint.h>
 #include <time.h>
 #include "connectivity.h"
 #include "time-utils.h"
+#include "random-pairs.h"
 #include "testcase-edge.h"
 
 static void edge_test(int object_num) {
@@ -45,6 +47,50 @@ static void edge_test(int object_num) {
     printf("======edge test with %d objects ends======\n", object_num);
 }
 
+// 64位序号的edge测试，随机输入对由种子RANDOM_PAIRS_DEFAULT_SEED的SplitMix64序列无偏地生成，每次运行都相同
+static void edge_test_64(int64_t object_num, enum storage_64_layout layout) {
+    printf("\n======64-bit edge test with %lld objects starts======\n", (long long)object_num);
+
+    if (getenv("CONNECTIVITY_HUGE_TESTS") == NULL) {
+        printf("skipped, set CONNECTIVITY_HUGE_TESTS to run.\n");
+        printf("======64-bit edge test with %lld objects ends======\n", (long long)object_num);
+        return;
+    }
+
+    struct storage_64 *storage = w_qunion_pc_h_64_new_storage(object_num, layout);
+    ck_assert_ptr_nonnull(storage);
+
+    int64_t pair[2] = {0};
+    unsigned long long edge_count = 0;
+    uint64_t state = random_pairs_stream(RANDOM_PAIRS_DEFAULT_SEED, 0);
+
+    clock_t start_time = clock();
+
+    int64_t i = 0;
+    while (i < object_num - 1) {
+        // 在其余object_num - 1个对象中选取pair[1]，使两个对象不同
+        pair[0] = random_pairs_below(&state, object_num);
+        pair[1] = random_pairs_below(&state, object_num - 1);
+        if (pair[1] >= pair[0]) pair[1]++;
+
+        if (w_qunion_pc_h_64_is_new_connection(storage, pair[0], pair[1])) {
+            i++;
+        }
+
+        edge_count++;
+    }
+
+    clock_t end_time = clock();
+
+    double cpu_time_used = compute_used_cpu_time(start_time, end_time);
+
+    printf("it takes %llu random edges to connect %lld objects.\n%f seconds has elapsed.\n", edge_count, (long long)object_num, cpu_time_used);
+
+    w_qunion_pc_h_64_delete_storage(storage);
+
+    printf("======64-bit edge test with %lld objects ends======\n", (long long)object_num);
+}
+
 START_TEST(edge_test_tiny_amount) {
     edge_test(1e3);
 } END_TEST
@@ -65,6 +111,10 @@ START_TEST(edge_test_massive_amount) {
     edge_test(1e7);
 } END_TEST
 
+START_TEST(edge_test_huge_amount) {
+    edge_test_64(2.5e9, STORAGE_64_PACKED40);
+} END_TEST
+
 void suite_add_test_case_edge(Suite *s) {
     TCase *tc_edge = tcase_create("Edge Testcase");
     tcase_set_timeout(tc_edge, 30);
@@ -74,5 +124,10 @@ void suite_add_test_case_edge(Suite *s) {
     tcase_add_test(tc_edge, edge_test_large_amount);
     tcase_add_test(tc_edge, edge_test_massive_amount);
     suite_add_tcase(s, tc_edge);
+
+    TCase *tc_edge_huge = tcase_create("Edge Testcase - huge amount");
+    tcase_set_timeout(tc_edge_huge, 7200);
+    tcase_add_test(tc_edge_huge, edge_test_huge_amount);
+    suite_add_tcase(s, tc_edge_huge);
     return;
 }
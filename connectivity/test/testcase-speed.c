@@ -1,23 +1,51 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "connectivity.h"
+#include "uf-engine.h"
+#include "connectivity-stats.h"
 #include "random-pairs.h"
+#include "workloads.h"
+#include "concurrent-runner.h"
 #include "time-utils.h"
+#include "memory-utils.h"
 #include "testcase-speed.h"
 
 static int g_object_num = 0;
 static int g_pair_num = 0;
 static struct random_pairs *g_input_pairs = NULL;
 static const char *g_scale = NULL;
+static const char *g_workload = NULL;
 
+// 环境变量CONNECTIVITY_WORKLOAD选择输入对的形态(见workloads.c)，默认为均匀随机的uniform
+// 设置了环境变量CONNECTIVITY_PAIR_CACHE(一个目录)时，
+// 各规模的输入对保存在该目录下的pairs-<形态>-<规模>.bin中，之后的运行直接映射该文件，不再重新生成
 void random_input_setup(int object_num, int pair_num, const char *scale) {
     g_object_num = object_num;
     g_pair_num = pair_num;
-    g_input_pairs = random_pairs_new(g_object_num, g_pair_num);
     g_scale = scale;
-    if (g_input_pairs == NULL) ck_abort_msg("fail to generate random pairs.\n");
-    printf("\n======speed test in %s amount starts======\n", g_scale);
+    g_input_pairs = NULL;
+    g_workload = getenv("CONNECTIVITY_WORKLOAD") != NULL ? getenv("CONNECTIVITY_WORKLOAD") : "uniform";
+
+    const char *cache_dir = getenv("CONNECTIVITY_PAIR_CACHE");
+    char path[4096];
+    if (cache_dir != NULL) {
+        snprintf(path, sizeof(path), "%s/pairs-%s-%s.bin", cache_dir, g_workload, scale);
+        g_input_pairs = random_pairs_load(path);
+        if (g_input_pairs != NULL && (g_input_pairs->object_num != object_num || g_input_pairs->pair_num != pair_num)) {
+            random_pairs_delete(g_input_pairs);
+            g_input_pairs = NULL;
+        }
+    }
+    if (g_input_pairs == NULL) {
+        g_input_pairs = workload_pairs_new(g_workload, g_object_num, g_pair_num, RANDOM_PAIRS_DEFAULT_SEED);
+        if (g_input_pairs != NULL && cache_dir != NULL) random_pairs_write(g_input_pairs, path);
+    }
+    if (g_input_pairs == NULL) ck_abort_msg("fail to generate %s pairs.\n", g_workload);
+    connectivity_stats_reset();
+    printf("\n======speed test in %s amount (%s workload) starts======\n", g_scale, g_workload);
 }
 
 void random_input_setup_tiny_amount(void) {
@@ -45,9 +73,21 @@ void random_input_teardown(void) {
     printf("======speed test in %s amount ends======\n", g_scale);
 }
 
-void print_used_time(const char *algorithm, clock_t start_time, clock_t end_time) {
+// 编译时定义了CONNECTIVITY_STATS时输出上次清零以来的搜索与联合统计，并清零，避免计入下一次计时
+void print_stats(void) {
+	connectivity_stats_print(stdout);
+	connectivity_stats_reset();
+}
+
+// 与print_used_time相同，但只处理了前pair_num个输入对
+void print_processed_time(const char *algorithm, int pair_num, clock_t start_time, clock_t end_time) {
     double cpu_time_used = compute_used_cpu_time(start_time, end_time);
-	printf("%s took %f seconds to process %d(%.1e) connections in %d(%.1e) objects.\n", algorithm, cpu_time_used,  g_pair_num,  (double)g_pair_num, g_object_num, (double)g_object_num);
+	printf("%s took %f seconds to process %d(%.1e) connections in %d(%.1e) objects.\n", algorithm, cpu_time_used,  pair_num,  (double)pair_num, g_object_num, (double)g_object_num);
+	print_stats();
+}
+
+void print_used_time(const char *algorithm, clock_t start_time, clock_t end_time) {
+	print_processed_time(algorithm, g_pair_num, start_time, end_time);
 }
 
 START_TEST(speed_test_qfind) {
@@ -135,6 +175,24 @@ START_TEST(speed_test_w_qunion_pc_h) {
     w_qunion_pc_h_delete_storage(storage);
 } END_TEST
 
+START_TEST(speed_test_w_qunion_pc_h_batch) {
+    struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    unsigned char *bitmap = malloc((g_pair_num + 7) / 8);
+    ck_assert_ptr_nonnull(bitmap);
+
+    clock_t start_time = clock();
+
+    w_qunion_pc_h_process_batch(storage, g_input_pairs->pairs, g_pair_num, bitmap);
+
+    clock_t end_time = clock();
+
+    print_used_time("weighted quick union with path compression by halving (batch with prefetch)", start_time, end_time);
+
+    free(bitmap);
+    w_qunion_pc_h_delete_storage(storage);
+} END_TEST
+
 START_TEST(speed_test_h_qunion) {
     struct storage_with_tree_height *storage = h_qunion_new_storage(g_object_num);
     ck_assert_ptr_nonnull(storage);
@@ -152,6 +210,513 @@ START_TEST(speed_test_h_qunion) {
     h_qunion_delete_storage(storage);
 } END_TEST
 
+// 通用Union-find引擎的速度测试，只测试带权重的策略组合
+#define SPEED_TEST_UF(name, description) \
+START_TEST(speed_test_uf_##name) { \
+    struct uf_storage *storage = uf_##name##_new_storage(g_object_num); \
+    ck_assert_ptr_nonnull(storage); \
+    clock_t start_time = clock(); \
+    for (int i = 0; i < g_pair_num; i++) { \
+        uf_##name##_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]); \
+    } \
+    clock_t end_time = clock(); \
+    print_used_time(description, start_time, end_time); \
+    uf_delete_storage(storage); \
+} END_TEST
+
+SPEED_TEST_UF(w_qunion, "engine: weighted quick union")
+SPEED_TEST_UF(w_qunion_il, "engine: weighted quick union (interleaved)")
+SPEED_TEST_UF(w_qunion_pc, "engine: weighted quick union with path compression")
+SPEED_TEST_UF(w_qunion_pc_il, "engine: weighted quick union with path compression (interleaved)")
+SPEED_TEST_UF(w_qunion_pc_h, "engine: weighted quick union with path compression by halving")
+SPEED_TEST_UF(w_qunion_pc_h_il, "engine: weighted quick union with path compression by halving (interleaved)")
+SPEED_TEST_UF(w_qunion_pc_h_neg, "engine: weighted quick union with path compression by halving (negative size at root)")
+SPEED_TEST_UF(w_qunion_pc_h_z, "engine: weighted quick union with path compression by halving (zero-initialized)")
+SPEED_TEST_UF(w_qunion_pc_s, "engine: weighted quick union with path compression by splitting")
+SPEED_TEST_UF(r_qunion_pc_h, "engine: ranked quick union with path compression by halving")
+SPEED_TEST_UF(r_qunion_pc_h_u8, "engine: ranked quick union with path compression by halving (byte rank)")
+SPEED_TEST_UF(r_qunion_pc_s, "engine: ranked quick union with path compression by splitting")
+
+#undef SPEED_TEST_UF
+
+// Concurrent-quick-union算法的速度测试，线程数从1开始倍增，直到CPU核数
+START_TEST(speed_test_c_qunion) {
+    int max_thread_num = concurrent_max_thread_num();
+    for (int thread_num = 1; ; thread_num = thread_num * 2 < max_thread_num ? thread_num * 2 : max_thread_num) {
+        struct concurrent_storage *storage = c_qunion_new_storage(g_object_num);
+        ck_assert_ptr_nonnull(storage);
+
+        struct timespec start_time = get_monotonic_time();
+        long long new_connection_num = concurrent_run_pairs(storage, g_input_pairs->pairs, g_pair_num, thread_num);
+        struct timespec end_time = get_monotonic_time();
+        ck_assert_int_ge(new_connection_num, 0);
+
+        printf("concurrent quick union with %d thread(s) took %f seconds to process %d(%.1e) connections in %d(%.1e) objects.\n",
+               thread_num, compute_elapsed_time(start_time, end_time), g_pair_num, (double)g_pair_num, g_object_num, (double)g_object_num);
+
+        c_qunion_delete_storage(storage);
+        if (thread_num == max_thread_num) break;
+    }
+} END_TEST
+
+// Read-mostly-weighted-quick-union算法的速度测试，一个写线程处理输入对，读线程数从0开始倍增，直到CPU核数，
+// 每种读线程数都要完整处理一遍输入对，为了在超时之前完成，输入对最多使用SPEED_TEST_RW_MAX_PAIRS个
+#define SPEED_TEST_RW_MAX_PAIRS 1000000
+START_TEST(speed_test_rw_qunion) {
+    int max_thread_num = concurrent_max_thread_num();
+    int pair_num = g_pair_num < SPEED_TEST_RW_MAX_PAIRS ? g_pair_num : SPEED_TEST_RW_MAX_PAIRS;
+    for (int reader_num = 0; ; reader_num = reader_num == 0 ? 1 : (reader_num * 2 < max_thread_num ? reader_num * 2 : max_thread_num)) {
+        struct rw_storage *storage = rw_qunion_new_storage(g_object_num);
+        ck_assert_ptr_nonnull(storage);
+
+        long long query_num, missed_num;
+        struct timespec start_time = get_monotonic_time();
+        long long new_connection_num = rw_run_pairs(storage, g_input_pairs->pairs, pair_num, reader_num, &query_num, &missed_num);
+        struct timespec end_time = get_monotonic_time();
+        ck_assert_int_ge(new_connection_num, 0);
+        ck_assert_int_eq(missed_num, 0);
+
+        double elapsed_time = compute_elapsed_time(start_time, end_time);
+        printf("read-mostly weighted quick union with %d reader(s) took %f seconds to process %d(%.1e) connections in %d(%.1e) objects, "
+               "readers answered %lld(%.2e per second) queries.\n",
+               reader_num, elapsed_time, pair_num, (double)pair_num, g_object_num, (double)g_object_num,
+               query_num, query_num / elapsed_time);
+
+        rw_qunion_delete_storage(storage);
+        if (reader_num == max_thread_num) break;
+    }
+} END_TEST
+#undef SPEED_TEST_RW_MAX_PAIRS
+
+// 离线并行连通分量算法的速度测试，与逐个处理输入对的Weighted-quick-union-with-path-compression-by-halving算法对比，
+// 线程数从1开始倍增，直到CPU核数
+START_TEST(speed_test_p_cc) {
+    struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    connectivity_stats_reset();
+    struct timespec start_time = get_monotonic_time();
+    for (int i = 0; i < g_pair_num; i++) w_qunion_pc_h_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+    struct timespec end_time = get_monotonic_time();
+    double sequential_time = compute_elapsed_time(start_time, end_time);
+    printf("sequential weighted quick union with path compression by halving took %f seconds to find %zu components.\n",
+           sequential_time, storage->component_num);
+    print_stats();
+
+    int max_thread_num = concurrent_max_thread_num();
+    for (int thread_num = 1; ; thread_num = thread_num * 2 < max_thread_num ? thread_num * 2 : max_thread_num) {
+        start_time = get_monotonic_time();
+        struct cc_labels *labels = p_cc_new_labels(g_input_pairs->pairs, g_pair_num, g_object_num, thread_num);
+        end_time = get_monotonic_time();
+        ck_assert_ptr_nonnull(labels);
+        ck_assert_uint_eq(labels->component_num, storage->component_num);
+
+        double elapsed_time = compute_elapsed_time(start_time, end_time);
+        printf("parallel connected components with %d thread(s) took %f seconds (%.2fx) to label %d(%.1e) objects with %d(%.1e) connections.\n",
+               thread_num, elapsed_time, sequential_time / elapsed_time, g_object_num, (double)g_object_num, g_pair_num, (double)g_pair_num);
+
+        p_cc_delete_labels(labels);
+        if (thread_num == max_thread_num) break;
+    }
+    w_qunion_pc_h_delete_storage(storage);
+} END_TEST
+
+// 并行计算新连接标志的速度测试，与w_qunion_pc_h_process_batch对比并检查结果相同，线程数从1开始倍增，直到CPU核数
+START_TEST(speed_test_p_cc_process_batch) {
+    unsigned char *expected = malloc((g_pair_num + 7) / 8);
+    unsigned char *bitmap = malloc((g_pair_num + 7) / 8);
+    struct storage_with_tree_size *storage = w_qunion_pc_h_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(expected);
+    ck_assert_ptr_nonnull(bitmap);
+    ck_assert_ptr_nonnull(storage);
+    connectivity_stats_reset();
+    struct timespec start_time = get_monotonic_time();
+    w_qunion_pc_h_process_batch(storage, g_input_pairs->pairs, g_pair_num, expected);
+    struct timespec end_time = get_monotonic_time();
+    double sequential_time = compute_elapsed_time(start_time, end_time);
+    printf("sequential weighted quick union with path compression by halving (batch) took %f seconds to flag %d(%.1e) connections.\n",
+           sequential_time, g_pair_num, (double)g_pair_num);
+    print_stats();
+
+    int max_thread_num = concurrent_max_thread_num();
+    for (int thread_num = 1; ; thread_num = thread_num * 2 < max_thread_num ? thread_num * 2 : max_thread_num) {
+        start_time = get_monotonic_time();
+        ck_assert(p_cc_process_batch(g_input_pairs->pairs, g_pair_num, g_object_num, thread_num, bitmap));
+        end_time = get_monotonic_time();
+        ck_assert_int_eq(memcmp(expected, bitmap, (g_pair_num + 7) / 8), 0);
+
+        double elapsed_time = compute_elapsed_time(start_time, end_time);
+        printf("parallel new connection flags with %d thread(s) took %f seconds (%.2fx) to flag %d(%.1e) connections in %d(%.1e) objects.\n",
+               thread_num, elapsed_time, sequential_time / elapsed_time, g_pair_num, (double)g_pair_num, g_object_num, (double)g_object_num);
+        if (thread_num == max_thread_num) break;
+    }
+    w_qunion_pc_h_delete_storage(storage);
+    free(bitmap);
+    free(expected);
+} END_TEST
+
+// Rollback-weighted-quick-union算法的速度测试:
+// 处理前一半输入对后，把后一半输入对分成多批，每批试探性地连接后再撤销，
+// 与每批之前复制整个存储结构的做法对比
+#define SPEED_TEST_RB_QUNION_BATCH 1000
+START_TEST(speed_test_rb_qunion) {
+    struct rollback_storage *storage = rb_qunion_new_storage(g_object_num);
+    int *data = malloc(sizeof(int) * g_object_num), *tree_size = malloc(sizeof(int) * g_object_num);
+    ck_assert_ptr_nonnull(storage);
+    ck_assert_ptr_nonnull(data);
+    ck_assert_ptr_nonnull(tree_size);
+    int base_num = g_pair_num / 2;
+    int batch_num = (g_pair_num - base_num) / SPEED_TEST_RB_QUNION_BATCH;
+    if (batch_num > 100) batch_num = 100;
+
+    connectivity_stats_reset();
+    clock_t start_time = clock();
+    for (int i = 0; i < base_num; i++) rb_qunion_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+    clock_t end_time = clock();
+    print_processed_time("rollback weighted quick union (first half)", base_num, start_time, end_time);
+
+    connectivity_stats_reset();
+    start_time = clock();
+    for (int b = 0; b < batch_num; b++) {
+        size_t checkpoint = rb_qunion_checkpoint(storage);
+        for (int i = base_num + b * SPEED_TEST_RB_QUNION_BATCH; i < base_num + (b + 1) * SPEED_TEST_RB_QUNION_BATCH; i++) {
+            rb_qunion_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+        }
+        ck_assert(rb_qunion_rollback(storage, checkpoint));
+    }
+    end_time = clock();
+    printf("rollback weighted quick union took %f seconds for %d speculative batches of %d pairs (rollback).\n",
+           compute_used_cpu_time(start_time, end_time), batch_num, SPEED_TEST_RB_QUNION_BATCH);
+    print_stats();
+
+    connectivity_stats_reset();
+    start_time = clock();
+    for (int b = 0; b < batch_num; b++) {
+        memcpy(data, storage->data, sizeof(int) * g_object_num);
+        memcpy(tree_size, storage->tree_size, sizeof(int) * g_object_num);
+        size_t undo_num = storage->undo_num, component_num = storage->component_num;
+        for (int i = base_num + b * SPEED_TEST_RB_QUNION_BATCH; i < base_num + (b + 1) * SPEED_TEST_RB_QUNION_BATCH; i++) {
+            rb_qunion_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+        }
+        memcpy(storage->data, data, sizeof(int) * g_object_num);
+        memcpy(storage->tree_size, tree_size, sizeof(int) * g_object_num);
+        storage->undo_num = undo_num;
+        storage->component_num = component_num;
+    }
+    end_time = clock();
+    printf("rollback weighted quick union took %f seconds for %d speculative batches of %d pairs (copy).\n",
+           compute_used_cpu_time(start_time, end_time), batch_num, SPEED_TEST_RB_QUNION_BATCH);
+    print_stats();
+
+    free(tree_size);
+    free(data);
+    rb_qunion_delete_storage(storage);
+} END_TEST
+#undef SPEED_TEST_RB_QUNION_BATCH
+
+// 离线动态连通性算法的速度测试:
+// 依次插入输入对，每插入两个输入对删除一个随机的仍存在的连接，
+// 每插入一个输入对进行一次查询，交替查询一个之前插入的输入对和两个随机对象，
+// 输入对最多使用SPEED_TEST_OD_MAX_PAIRS个
+#define SPEED_TEST_OD_MAX_PAIRS 2000000
+START_TEST(speed_test_od_process_batch) {
+    int pair_num = g_pair_num < SPEED_TEST_OD_MAX_PAIRS ? g_pair_num : SPEED_TEST_OD_MAX_PAIRS;
+    size_t operation_num = 0, capacity = (size_t)pair_num * 5 / 2 + 1;
+    struct dynamic_operation *operations = malloc(sizeof(*operations) * capacity);
+    int *live = malloc(sizeof(*live) * pair_num);
+    unsigned char *bitmap = malloc((capacity + 7) / 8);
+    ck_assert_ptr_nonnull(operations);
+    ck_assert_ptr_nonnull(live);
+    ck_assert_ptr_nonnull(bitmap);
+
+    uint64_t state = RANDOM_PAIRS_DEFAULT_SEED;
+    int live_num = 0;
+    for (int i = 0; i < pair_num; i++) {
+        int (*pairs)[2] = g_input_pairs->pairs;
+        operations[operation_num++] = (struct dynamic_operation){DYNAMIC_INSERT, pairs[i][0], pairs[i][1]};
+        live[live_num++] = i;
+        if (i % 2 == 1) {
+            int k = random_pairs_below(&state, live_num);
+            operations[operation_num++] = (struct dynamic_operation){DYNAMIC_DELETE, pairs[live[k]][0], pairs[live[k]][1]};
+            live[k] = live[--live_num];
+        }
+        if (i % 2 == 0) {
+            int j = random_pairs_below(&state, i + 1);
+            operations[operation_num++] = (struct dynamic_operation){DYNAMIC_QUERY, pairs[j][0], pairs[j][1]};
+        } else {
+            operations[operation_num++] = (struct dynamic_operation){DYNAMIC_QUERY,
+                random_pairs_below(&state, g_object_num), random_pairs_below(&state, g_object_num)};
+        }
+    }
+
+    connectivity_stats_reset();
+    clock_t start_time = clock();
+    ck_assert(od_process_batch(operations, operation_num, g_object_num, bitmap));
+    clock_t end_time = clock();
+    size_t connected_num = 0;
+    for (size_t i = 0; i < (operation_num + 7) / 8; i++) connected_num += __builtin_popcount(bitmap[i]);
+    printf("offline dynamic connectivity took %f seconds to process %zu(%.1e) operations "
+           "(%d insertions, %d deletions, %d queries, %zu connected) in %d(%.1e) objects.\n",
+           compute_used_cpu_time(start_time, end_time), operation_num, (double)operation_num,
+           pair_num, pair_num / 2, pair_num, connected_num, g_object_num, (double)g_object_num);
+    print_stats();
+
+    free(bitmap);
+    free(live);
+    free(operations);
+} END_TEST
+#undef SPEED_TEST_OD_MAX_PAIRS
+
+// Versioned-weighted-quick-union算法的速度测试:
+// 处理所有输入对后，在随机的历史版本上查询随机的对象对，并查询它们开始连接的版本，
+// 与从头重放输入对到查询的版本的做法对比，重放只在SPEED_TEST_VR_QUNION_REPLAYS个均匀分布的版本上进行，
+// 为了在超时之前完成，输入对最多使用SPEED_TEST_VR_QUNION_MAX_PAIRS个，
+// 这仍是最大规模对象数的2倍，绝大多数对象最终都已连接，查询会追溯到较深的节点
+#define SPEED_TEST_VR_QUNION_QUERIES 1000000
+#define SPEED_TEST_VR_QUNION_REPLAYS 1
+#define SPEED_TEST_VR_QUNION_MAX_PAIRS 20000000
+START_TEST(speed_test_vr_qunion) {
+    int pair_num = g_pair_num < SPEED_TEST_VR_QUNION_MAX_PAIRS ? g_pair_num : SPEED_TEST_VR_QUNION_MAX_PAIRS;
+    struct versioned_storage *storage = vr_qunion_new_storage(g_object_num);
+    ck_assert_ptr_nonnull(storage);
+
+    connectivity_stats_reset();
+    clock_t start_time = clock();
+    for (int i = 0; i < pair_num; i++) vr_qunion_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+    clock_t end_time = clock();
+    print_processed_time("versioned weighted quick union", pair_num, start_time, end_time);
+
+    uint64_t state = RANDOM_PAIRS_DEFAULT_SEED;
+    size_t connected_num = 0;
+    connectivity_stats_reset();
+    start_time = clock();
+    for (int k = 0; k < SPEED_TEST_VR_QUNION_QUERIES; k++) {
+        int p = random_pairs_below(&state, g_object_num), q = random_pairs_below(&state, g_object_num);
+        connected_num += vr_qunion_connected_at(storage, p, q, random_pairs_below(&state, pair_num + 1));
+    }
+    end_time = clock();
+    printf("versioned weighted quick union took %f seconds for %d(%.1e) connected_at queries (%zu connected).\n",
+           compute_used_cpu_time(start_time, end_time), SPEED_TEST_VR_QUNION_QUERIES, (double)SPEED_TEST_VR_QUNION_QUERIES, connected_num);
+    print_stats();
+
+    connected_num = 0;
+    connectivity_stats_reset();
+    start_time = clock();
+    for (int k = 0; k < SPEED_TEST_VR_QUNION_QUERIES; k++) {
+        int p = random_pairs_below(&state, g_object_num), q = random_pairs_below(&state, g_object_num);
+        connected_num += vr_qunion_connected_since(storage, p, q) != VR_QUNION_NEVER;
+    }
+    end_time = clock();
+    printf("versioned weighted quick union took %f seconds for %d(%.1e) connected_since queries (%zu connected).\n",
+           compute_used_cpu_time(start_time, end_time), SPEED_TEST_VR_QUNION_QUERIES, (double)SPEED_TEST_VR_QUNION_QUERIES, connected_num);
+    print_stats();
+
+    // 重放的结果必须与历史查询相同
+    connectivity_stats_reset();
+    start_time = clock();
+    for (int k = 1; k <= SPEED_TEST_VR_QUNION_REPLAYS; k++) {
+        int version = (long long)pair_num * k / (SPEED_TEST_VR_QUNION_REPLAYS + 1);
+        int p = random_pairs_below(&state, g_object_num), q = random_pairs_below(&state, g_object_num);
+        struct storage_with_tree_size *replay = w_qunion_pc_h_new_storage(g_object_num);
+        ck_assert_ptr_nonnull(replay);
+        for (int i = 0; i < version; i++) w_qunion_pc_h_is_new_connection(replay, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+        ck_assert_int_eq(w_qunion_pc_h_connected(replay, p, q), vr_qunion_connected_at(storage, p, q, version));
+        w_qunion_pc_h_delete_storage(replay);
+    }
+    end_time = clock();
+    printf("replaying with weighted quick union with path compression by halving took %f seconds per query (%d queries).\n",
+           compute_used_cpu_time(start_time, end_time) / SPEED_TEST_VR_QUNION_REPLAYS, SPEED_TEST_VR_QUNION_REPLAYS);
+    print_stats();
+
+    vr_qunion_delete_storage(storage);
+} END_TEST
+#undef SPEED_TEST_VR_QUNION_MAX_PAIRS
+#undef SPEED_TEST_VR_QUNION_REPLAYS
+#undef SPEED_TEST_VR_QUNION_QUERIES
+
+// 64位序号的算法在int规模下的速度测试
+#define SPEED_TEST_64(name, layout, description) \
+START_TEST(speed_test_##name##_##layout) { \
+    struct storage_64 *storage = name##_new_storage(g_object_num, layout); \
+    ck_assert_ptr_nonnull(storage); \
+    clock_t start_time = clock(); \
+    for (int i = 0; i < g_pair_num; i++) { \
+        name##_is_new_connection(storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]); \
+    } \
+    clock_t end_time = clock(); \
+    print_used_time(description, start_time, end_time); \
+    name##_delete_storage(storage); \
+} END_TEST
+
+SPEED_TEST_64(w_qunion_pc_h_64, STORAGE_64_WIDE, "64-bit weighted quick union with path compression by halving")
+SPEED_TEST_64(w_qunion_pc_h_64, STORAGE_64_PACKED40, "64-bit weighted quick union with path compression by halving (40-bit packed)")
+
+#undef SPEED_TEST_64
+
+// 超过INT_MAX个对象的规模需要十几GB内存，只在设置了环境变量CONNECTIVITY_HUGE_TESTS时运行
+static int64_t g_object_num_64 = 0;
+static int64_t g_pair_num_64 = 0;
+static struct random_pairs_64 *g_input_pairs_64 = NULL;
+
+void random_input_setup_huge_amount(void) {
+    printf("\n======speed test in huge amount starts======\n");
+    if (getenv("CONNECTIVITY_HUGE_TESTS") == NULL) {
+        printf("skipped, set CONNECTIVITY_HUGE_TESTS to run.\n");
+        return;
+    }
+    g_object_num_64 = 2.5e9;
+    g_pair_num_64 = 1e8;
+    g_input_pairs_64 = random_pairs_64_new(g_object_num_64, g_pair_num_64);
+    if (g_input_pairs_64 == NULL) ck_abort_msg("fail to generate random pairs.\n");
+}
+
+void random_input_teardown_huge_amount(void) {
+    if (g_input_pairs_64 != NULL) random_pairs_64_delete(g_input_pairs_64);
+    g_input_pairs_64 = NULL;
+    printf("======speed test in huge amount ends======\n");
+}
+
+#define SPEED_TEST_64_HUGE(name, layout, description) \
+START_TEST(speed_test_##name##_##layout##_huge) { \
+    if (g_input_pairs_64 == NULL) return; \
+    struct storage_64 *storage = name##_new_storage(g_object_num_64, layout); \
+    if (storage == NULL) { \
+        printf("%s skipped, not enough memory for %lld objects.\n", description, (long long)g_object_num_64); \
+        return; \
+    } \
+    clock_t start_time = clock(); \
+    for (int64_t i = 0; i < g_pair_num_64; i++) { \
+        name##_is_new_connection(storage, g_input_pairs_64->pairs[i][0], g_input_pairs_64->pairs[i][1]); \
+    } \
+    clock_t end_time = clock(); \
+    printf("%s took %f seconds to process %lld(%.1e) connections in %lld(%.1e) objects.\n", description, \
+           compute_used_cpu_time(start_time, end_time), (long long)g_pair_num_64, (double)g_pair_num_64, \
+           (long long)g_object_num_64, (double)g_object_num_64); \
+    name##_delete_storage(storage); \
+} END_TEST
+
+SPEED_TEST_64_HUGE(w_qunion_pc_h_64, STORAGE_64_WIDE, "64-bit weighted quick union with path compression by halving")
+SPEED_TEST_64_HUGE(w_qunion_pc_h_64, STORAGE_64_PACKED40, "64-bit weighted quick union with path compression by halving (40-bit packed)")
+
+#undef SPEED_TEST_64_HUGE
+
+// 映射到文件的存储的速度测试，同时给出新建和重新打开存储文件的耗时
+START_TEST(speed_test_mmap_storage) {
+    char path[] = "/tmp/connectivity-mmap-XXXXXX";
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+
+    struct timespec start_time = get_monotonic_time();
+    struct mmap_storage *storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+    struct timespec end_time = get_monotonic_time();
+    ck_assert_ptr_nonnull(storage);
+    printf("mmap storage took %f seconds to create a file for %d(%.1e) objects.\n",
+           compute_elapsed_time(start_time, end_time), g_object_num, (double)g_object_num);
+
+    clock_t start_clock = clock();
+    for (int i = 0; i < g_pair_num; i++) {
+        w_qunion_pc_h_is_new_connection(&storage->storage, g_input_pairs->pairs[i][0], g_input_pairs->pairs[i][1]);
+    }
+    clock_t end_clock = clock();
+    print_used_time("weighted quick union with path compression by halving (mmap storage)", start_clock, end_clock);
+
+    mmap_storage_sync(storage);
+    mmap_storage_close(storage);
+
+    start_time = get_monotonic_time();
+    storage = mmap_storage_open(path, MMAP_STORAGE_W_QUNION_PC_H, g_object_num);
+    end_time = get_monotonic_time();
+    ck_assert_ptr_nonnull(storage);
+    printf("mmap storage took %f seconds to reopen a file for %d(%.1e) objects.\n",
+           compute_elapsed_time(start_time, end_time), g_object_num, (double)g_object_num);
+
+    mmap_storage_close(storage);
+    unlink(path);
+} END_TEST
+
+// 输入对文件的载入速度测试: 写出当前的输入对后重新映射，并读取全部序号
+START_TEST(speed_test_pair_file) {
+    char path[] = "/tmp/connectivity-pairs-XXXXXX";
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+    ck_assert(random_pairs_write(g_input_pairs, path));
+
+    struct timespec start_time = get_monotonic_time();
+    struct pair_file *file = pair_file_open(path);
+    ck_assert_ptr_nonnull(file);
+    bool valid = pair_file_validate(file);
+    struct timespec end_time = get_monotonic_time();
+    ck_assert(valid);
+
+    double elapsed = compute_elapsed_time(start_time, end_time);
+    double bytes = (double)sizeof(int[2]) * g_pair_num;
+    printf("pair file took %f seconds to load and scan %d(%.1e) pairs, %.2f GB per second.\n",
+           elapsed, g_pair_num, (double)g_pair_num, elapsed > 0 ? bytes / elapsed / 1e9 : 0.0);
+
+    pair_file_close(file);
+    unlink(path);
+} END_TEST
+
+// 比较初始化循环与零初始化排列的启动耗时和内存占用
+// 只使用序号最小的1%对象的输入对模拟稀疏的序号分布
+#define SPEED_TEST_UF_STARTUP(name, description) \
+START_TEST(speed_test_uf_startup_##name) { \
+    long memory_before = get_resident_memory_kb(); \
+    struct timespec start_time = get_monotonic_time(); \
+    struct uf_storage *storage = uf_##name##_new_storage(g_object_num); \
+    struct timespec end_time = get_monotonic_time(); \
+    ck_assert_ptr_nonnull(storage); \
+    long memory_created = get_resident_memory_kb(); \
+    int sparse_object_num = g_object_num / 100 < 2 ? 2 : g_object_num / 100; \
+    for (int i = 0; i < g_pair_num / 100; i++) { \
+        uf_##name##_is_new_connection(storage, g_input_pairs->pairs[i][0] % sparse_object_num, g_input_pairs->pairs[i][1] % sparse_object_num); \
+    } \
+    long memory_used = get_resident_memory_kb(); \
+    printf("%s took %f seconds to create storage for %d(%.1e) objects, resident memory grew by %ld KB after creation and %ld KB after sparse use.\n", \
+           description, compute_elapsed_time(start_time, end_time), g_object_num, (double)g_object_num, \
+           memory_created - memory_before, memory_used - memory_before); \
+    uf_delete_storage(storage); \
+} END_TEST
+
+SPEED_TEST_UF_STARTUP(w_qunion_pc_h, "engine startup: initialization loop")
+SPEED_TEST_UF_STARTUP(w_qunion_pc_h_neg, "engine startup: initialization loop (negative size at root)")
+SPEED_TEST_UF_STARTUP(w_qunion_pc_h_z, "engine startup: zero-initialized")
+
+#undef SPEED_TEST_UF_STARTUP
+
+// Keyed-quick-union算法的速度测试，输入对的序号被打散为分布在整个64位范围内的键
+// 预估的键的个数只有对象个数的1/16，扩容的耗时也计入在内
+#define SPEED_TEST_K_QUNION(suffix, description, process) \
+START_TEST(speed_test_k_qunion##suffix) { \
+    uint64_t (*keys)[2] = malloc(sizeof(*keys) * g_pair_num); \
+    unsigned char *bitmap = malloc((g_pair_num + 7) / 8); \
+    ck_assert_ptr_nonnull(keys); \
+    ck_assert_ptr_nonnull(bitmap); \
+    for (int i = 0; i < g_pair_num; i++) { \
+        keys[i][0] = (uint64_t)g_input_pairs->pairs[i][0] * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL; \
+        keys[i][1] = (uint64_t)g_input_pairs->pairs[i][1] * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL; \
+    } \
+    struct keyed_storage *storage = k_qunion_new_storage(g_object_num / 16); \
+    ck_assert_ptr_nonnull(storage); \
+    clock_t start_time = clock(); \
+    process; \
+    clock_t end_time = clock(); \
+    print_used_time(description, start_time, end_time); \
+    printf("%s throughput: %.2e pairs per second, %zu distinct keys.\n", description, \
+           g_pair_num / compute_used_cpu_time(start_time, end_time), storage->key_num); \
+    k_qunion_delete_storage(storage); \
+    free(bitmap); \
+    free(keys); \
+} END_TEST
+
+SPEED_TEST_K_QUNION(, "keyed quick union",
+    for (int i = 0; i < g_pair_num; i++) k_qunion_is_new_connection(storage, keys[i][0], keys[i][1]))
+SPEED_TEST_K_QUNION(_batch, "keyed quick union (batch)",
+    k_qunion_process_batch(storage, keys, g_pair_num, bitmap))
+
+#undef SPEED_TEST_K_QUNION
+
 void suite_add_testcase_speed(Suite *s) {
 
 #define TC_SPEED(scale, timeout) \
@@ -164,7 +729,36 @@ do { \
     tcase_add_test(tc_speed_##scale, speed_test_w_qunion); \
     tcase_add_test(tc_speed_##scale, speed_test_w_qunion_pc); \
     tcase_add_test(tc_speed_##scale, speed_test_w_qunion_pc_h); \
+    tcase_add_test(tc_speed_##scale, speed_test_w_qunion_pc_h_batch); \
     tcase_add_test(tc_speed_##scale, speed_test_h_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_c_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_rw_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_p_cc); \
+    tcase_add_test(tc_speed_##scale, speed_test_p_cc_process_batch); \
+    tcase_add_test(tc_speed_##scale, speed_test_rb_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_od_process_batch); \
+    tcase_add_test(tc_speed_##scale, speed_test_vr_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_w_qunion_pc_h_64_STORAGE_64_WIDE); \
+    tcase_add_test(tc_speed_##scale, speed_test_w_qunion_pc_h_64_STORAGE_64_PACKED40); \
+    tcase_add_test(tc_speed_##scale, speed_test_mmap_storage); \
+    tcase_add_test(tc_speed_##scale, speed_test_k_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_k_qunion_batch); \
+    tcase_add_test(tc_speed_##scale, speed_test_pair_file); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_il); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_il); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_h); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_h_il); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_h_neg); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_h_z); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_startup_w_qunion_pc_h); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_startup_w_qunion_pc_h_neg); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_startup_w_qunion_pc_h_z); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_w_qunion_pc_s); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_r_qunion_pc_h); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_r_qunion_pc_h_u8); \
+    tcase_add_test(tc_speed_##scale, speed_test_uf_r_qunion_pc_s); \
     suite_add_tcase(s, tc_speed_##scale); \
 } while (0);
 
@@ -176,5 +770,12 @@ do { \
 
 #undef TC_SPEED
 
+    TCase *tc_speed_huge = tcase_create("Speed Testcase - huge amount");
+    tcase_set_timeout(tc_speed_huge, 600);
+    tcase_add_unchecked_fixture(tc_speed_huge, random_input_setup_huge_amount, random_input_teardown_huge_amount);
+    tcase_add_test(tc_speed_huge, speed_test_w_qunion_pc_h_64_STORAGE_64_WIDE_huge);
+    tcase_add_test(tc_speed_huge, speed_test_w_qunion_pc_h_64_STORAGE_64_PACKED40_huge);
+    suite_add_tcase(s, tc_speed_huge);
+
     return;
 }
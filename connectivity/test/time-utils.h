@@ -7,4 +7,15 @@ static inline double compute_used_cpu_time(clock_t start_time, clock_t end_time)
     return ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
 }
 
+// 多线程测试不能用clock()计时(clock()返回所有线程消耗的CPU时间之和)，需要使用单调时钟
+static inline struct timespec get_monotonic_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now;
+}
+
+static inline double compute_elapsed_time(struct timespec start_time, struct timespec end_time) {
+    return (double)(end_time.tv_sec - start_time.tv_sec) + (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
 #endif // HEADER_TIME_UTILS_H
\ No newline at end of file
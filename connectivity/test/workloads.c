@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "workloads.h"
+
+// 各形态的输入对都只由种子和输入对的序号决定，与random_pairs_fill相同
+
+// 可以把稀疏的序号打散到整个[0, n)范围内的双射: i -> (i * multiplier + offset) mod n
+struct workload_scatter {
+    uint64_t multiplier, offset, object_num;
+};
+
+static uint64_t workload_gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static struct workload_scatter workload_scatter_new(uint64_t object_num, uint64_t seed) {
+    struct workload_scatter scatter;
+    uint64_t state = random_pairs_stream(seed, UINT64_MAX);
+    scatter.object_num = object_num;
+    scatter.offset = random_pairs_below(&state, object_num);
+    // 乘数与n互素时才是双射
+    scatter.multiplier = random_pairs_below(&state, object_num) | 1;
+    while (workload_gcd(scatter.multiplier, object_num) != 1) scatter.multiplier += 2;
+    scatter.multiplier %= object_num;
+    return scatter;
+}
+
+static inline int workload_scatter(const struct workload_scatter *scatter, uint64_t i) {
+    return (i * scatter->multiplier + scatter->offset) % scatter->object_num;
+}
+
+// 均匀随机输入对，与random_pairs_new相同
+static void workload_uniform(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    random_pairs_fill(pairs, object_num, pair_num, seed, 0);
+}
+
+// Quick-union算法的最坏情况: 0-1, 0-2, 0-3 ...
+// 每次联合都把0所在的树连接到新对象之下，形成一条长度为N-1的链，
+// 之后的输入对都是从链的最底端0到随机对象的查询
+static void workload_chain(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    for (int i = 0; i < pair_num; i++) {
+        if (i < object_num - 1) {
+            pairs[i][0] = 0;
+            pairs[i][1] = i + 1;
+        } else {
+            uint64_t state = random_pairs_stream(seed, i);
+            pairs[i][0] = 0;
+            pairs[i][1] = random_pairs_below(&state, object_num - 1) + 1;
+        }
+    }
+}
+
+// Weighted-quick-union算法的最坏情况(见weighted-quick-union-worst-graph-*.gv):
+// 先把对象两两联合为高度为1的树，再把高度为1的树两两联合为高度为2的树，以此类推，
+// 只使用不超过N的最大的2的整数幂个对象，之后的输入对都是这些对象之间的随机查询
+static void workload_binomial(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    int used_num = 1;
+    while (used_num <= object_num / 2) used_num *= 2;
+
+    int i = 0;
+    for (int step = 1; step < used_num && i < pair_num; step *= 2) {
+        for (int j = 0; j < used_num && i < pair_num; j += step * 2, i++) {
+            pairs[i][0] = j;
+            pairs[i][1] = j + step;
+        }
+    }
+    for (; i < pair_num; i++) {
+        uint64_t state = random_pairs_stream(seed, i);
+        int p = random_pairs_below(&state, used_num);
+        int q = random_pairs_below(&state, used_num - 1);
+        pairs[i][0] = p;
+        pairs[i][1] = q >= p ? q + 1 : q;
+    }
+}
+
+// 近似参数为1的Zipf分布: 排名为k的对象出现的概率约与1/(k+1)成正比，
+// 排名经打散后才作为对象的序号，使热点对象分散在数组中
+static void workload_zipf(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    struct workload_scatter scatter = workload_scatter_new(object_num, seed);
+    double log_range = log((double)object_num + 1);
+    for (int i = 0; i < pair_num; i++) {
+        uint64_t state = random_pairs_stream(seed, i);
+        int rank[2];
+        do {
+            for (int k = 0; k < 2; k++) {
+                rank[k] = (int)floor(exp(random_pairs_unit(&state) * log_range)) - 1;
+                if (rank[k] >= object_num) rank[k] = object_num - 1;
+            }
+        } while (rank[0] == rank[1]);
+        pairs[i][0] = workload_scatter(&scatter, rank[0]);
+        pairs[i][1] = workload_scatter(&scatter, rank[1]);
+    }
+}
+
+// 局部聚集的输入对: 90%的输入对的两个对象的序号相差不超过WORKLOAD_CLUSTER_WIDTH，其余的均匀随机
+#define WORKLOAD_CLUSTER_WIDTH 64
+
+static void workload_cluster(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    for (int i = 0; i < pair_num; i++) {
+        uint64_t state = random_pairs_stream(seed, i);
+        int p = random_pairs_below(&state, object_num), q;
+        if (random_pairs_below(&state, 10) == 0) {
+            q = random_pairs_below(&state, object_num - 1);
+        } else {
+            int low = p - WORKLOAD_CLUSTER_WIDTH < 0 ? 0 : p - WORKLOAD_CLUSTER_WIDTH;
+            int high = p + WORKLOAD_CLUSTER_WIDTH >= object_num ? object_num - 1 : p + WORKLOAD_CLUSTER_WIDTH;
+            q = low + random_pairs_below(&state, high - low);
+        }
+        pairs[i][0] = p;
+        pairs[i][1] = q >= p ? q + 1 : q;
+    }
+}
+
+// R-MAT图的边(与Graph500相同的参数a=0.57, b=0.19, c=0.19)，
+// 超出范围或两端相同的边重新生成，对象的序号经过打散
+static void workload_rmat(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    struct workload_scatter scatter = workload_scatter_new(object_num, seed);
+    int scale = 0;
+    while (((int64_t)1 << scale) < object_num) scale++;
+
+    for (int i = 0; i < pair_num; i++) {
+        uint64_t state = random_pairs_stream(seed, i);
+        int64_t p, q;
+        do {
+            p = q = 0;
+            for (int level = 0; level < scale; level++) {
+                double r = random_pairs_unit(&state);
+                int p_bit = r >= 0.57 + 0.19;
+                int q_bit = (r >= 0.57 && r < 0.57 + 0.19) || r >= 0.57 + 0.19 + 0.19;
+                p = p << 1 | p_bit;
+                q = q << 1 | q_bit;
+            }
+        } while (p >= object_num || q >= object_num || p == q);
+        pairs[i][0] = workload_scatter(&scatter, p);
+        pairs[i][1] = workload_scatter(&scatter, q);
+    }
+}
+
+// 以查询为主的输入对: 对象被分成WORKLOAD_QUERY_GROUP个一组(经过打散)，
+// 前面的输入对把每一组连接成一个树，之后的输入对都是同一组内两个对象之间的查询，
+// 输入对个数为对象个数的5倍时，约80%的输入对是已有的连接
+#define WORKLOAD_QUERY_GROUP 16
+
+static void workload_query(int (*pairs)[2], int object_num, int pair_num, uint64_t seed) {
+    struct workload_scatter scatter = workload_scatter_new(object_num, seed);
+    int group_num = (object_num + WORKLOAD_QUERY_GROUP - 1) / WORKLOAD_QUERY_GROUP;
+    int union_num = object_num - group_num;
+
+    for (int i = 0; i < pair_num; i++) {
+        uint64_t state = random_pairs_stream(seed, i);
+        int slot, other;
+        if (i < union_num) {
+            // 第i个联合对应组内的第member个对象，与组内之前的某个随机对象连接
+            int group = i / (WORKLOAD_QUERY_GROUP - 1), member = i % (WORKLOAD_QUERY_GROUP - 1) + 1;
+            slot = group * WORKLOAD_QUERY_GROUP + member;
+            other = group * WORKLOAD_QUERY_GROUP + random_pairs_below(&state, member);
+        } else {
+            int group = random_pairs_below(&state, group_num);
+            // 最后一组可能只有一个对象，此时改用第一组
+            if (object_num - group * WORKLOAD_QUERY_GROUP < 2) group = 0;
+            int group_size = object_num - group * WORKLOAD_QUERY_GROUP;
+            if (group_size > WORKLOAD_QUERY_GROUP) group_size = WORKLOAD_QUERY_GROUP;
+            int member = random_pairs_below(&state, group_size);
+            int other_member = random_pairs_below(&state, group_size - 1);
+            if (other_member >= member) other_member++;
+            slot = group * WORKLOAD_QUERY_GROUP + member;
+            other = group * WORKLOAD_QUERY_GROUP + other_member;
+        }
+        pairs[i][0] = workload_scatter(&scatter, slot);
+        pairs[i][1] = workload_scatter(&scatter, other);
+    }
+}
+
+struct workload {
+    const char *name;
+    void (*generate)(int (*pairs)[2], int object_num, int pair_num, uint64_t seed);
+};
+
+static const struct workload g_workloads[] = {
+    {"uniform", workload_uniform},
+    {"chain", workload_chain},
+    {"binomial", workload_binomial},
+    {"zipf", workload_zipf},
+    {"cluster", workload_cluster},
+    {"rmat", workload_rmat},
+    {"query", workload_query}
+};
+
+const char *workload_name(int i) {
+    if (i < 0 || i >= sizeof(g_workloads) / sizeof(g_workloads[0])) return NULL;
+    return g_workloads[i].name;
+}
+
+struct random_pairs *workload_pairs_new(const char *name, int object_num, int pair_num, uint64_t seed) {
+    if (object_num < 2 || pair_num < 0) return NULL;
+
+    const struct workload *workload = NULL;
+    for (int i = 0; i < sizeof(g_workloads) / sizeof(g_workloads[0]); i++) {
+        if (strcmp(g_workloads[i].name, name) == 0) workload = &g_workloads[i];
+    }
+    if (workload == NULL) return NULL;
+
+    struct random_pairs *res = malloc(sizeof(*res));
+    int (*pairs)[2] = malloc(sizeof(*pairs) * pair_num);
+    if (res == NULL || pairs == NULL) {
+        free(res);
+        free(pairs);
+        return NULL;
+    }
+
+    workload->generate(pairs, object_num, pair_num, seed);
+
+    res->pairs = pairs;
+    res->object_num = object_num;
+    res->pair_num = pair_num;
+    res->file = NULL;
+
+    return res;
+}
@@ -0,0 +1,14 @@
+#ifndef HEADER_WORKLOADS_H
+#define HEADER_WORKLOADS_H
+
+#include <stdint.h>
+#include "random-pairs.h"
+
+// 按名称生成不同形态的输入对，可用的名称见workloads.c中的g_workloads，
+// 名称未知或参数不合法时返回NULL，返回值用random_pairs_delete释放
+struct random_pairs *workload_pairs_new(const char *name, int object_num, int pair_num, uint64_t seed);
+
+// 第i个输入对形态的名称，i超出范围时返回NULL
+const char *workload_name(int i);
+
+#endif // HEADER_WORKLOADS_H
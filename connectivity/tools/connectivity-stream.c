@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "connectivity.h"
+#include "uf-engine.h"
+
+/****************************************
+ * connectivity-stream: 连接问题的流式处理程序。
+ *
+ * 各算法文件中的DOC_COMPILE版main函数用scanf读取输入对、用printf打印新连接，
+ * 每秒只能处理几百万个输入对，远低于算法本身的速度，耗时几乎全部花在格式化输入输出上。
+ *
+ * 本程序:
+ * - 输入是普通文件时用mmap映射整个文件，否则用read按大块读入，
+ *   再用pair_text_parse(见19-pair-text.c)直接扫描缓冲区，不经过stdio。
+ * - 每解析STREAM_BATCH_PAIRS个输入对交给引擎处理一次，
+ *   新连接写入输出缓冲区，缓冲区满时才用write一次性输出。
+ * - 用-e选择通用引擎中的任意一种策略组合和排列方式，
+ *   每种组合都有自己的完全内联的处理循环。
+ * - 处理结束后在标准错误上报告输入对的个数、新连接的个数和每秒处理的输入对个数。
+ *
+ * 输入格式与DOC_COMPILE版main函数相同: 以空白字符分隔的非负整数，每两个组成一个输入对。
+ * 输入文件也可以是pair_file_write写出的二进制输入对文件，
+ * 此时文件中的输入对数组被直接映射后交给引擎，不需要任何解析，
+ * 不给出-n时，对象个数取自文件头。
+ ****************************************/
+
+/**
+ * @brief 每批交给引擎处理的输入对个数。
+ */
+#define STREAM_BATCH_PAIRS 4096
+
+/**
+ * @brief 非mmap输入时每次read的字节数。
+ */
+#define STREAM_READ_SIZE (1 << 20)
+
+/**
+ * @brief 输出缓冲区的字节数。
+ */
+#define STREAM_OUTPUT_SIZE (1 << 20)
+
+/**
+ * @brief 一个输入对的输出最多占用的字节数: 两个int、一个空格和一个换行符。
+ */
+#define STREAM_MAX_PAIR_TEXT 24
+
+struct stream_output {
+    char *buffer;
+    size_t length;
+    bool enabled;
+};
+
+static void stream_write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            perror("connectivity-stream: write");
+            exit(EXIT_FAILURE);
+        }
+        data += written;
+        length -= written;
+    }
+    return;
+}
+
+static void stream_output_flush(struct stream_output *output) {
+    stream_write_all(STDOUT_FILENO, output->buffer, output->length);
+    output->length = 0;
+    return;
+}
+
+static inline char *stream_format_int(char *cursor, int value) {
+    char digits[12];
+    int n = 0;
+    unsigned int v = value;
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) *cursor++ = digits[--n];
+    return cursor;
+}
+
+static inline void stream_output_pair(struct stream_output *output, int p, int q) {
+    if (output->length > STREAM_OUTPUT_SIZE - STREAM_MAX_PAIR_TEXT) stream_output_flush(output);
+    char *cursor = output->buffer + output->length;
+    cursor = stream_format_int(cursor, p);
+    *cursor++ = ' ';
+    cursor = stream_format_int(cursor, q);
+    *cursor++ = '\n';
+    output->length = cursor - output->buffer;
+    return;
+}
+
+/**
+ * @brief 引擎中的一种组合，process处理一批输入对并返回其中新连接的个数。
+ */
+struct stream_engine {
+    const char *name;
+    enum uf_link_policy link;
+    enum uf_layout layout;
+    size_t (*process)(struct uf_storage *storage, int (*pairs)[2], size_t pair_num, struct stream_output *output);
+};
+
+#define STREAM_DEFINE_PROCESS(name, link, compress, layout) \
+    static size_t stream_process_##name(struct uf_storage *storage, int (*pairs)[2], size_t pair_num, struct stream_output *output) { \
+        size_t new_num = 0; \
+        for (size_t i = 0; i < pair_num; i++) { \
+            if (uf_##name##_is_new_connection(storage, pairs[i][0], pairs[i][1])) { \
+                new_num++; \
+                if (output->enabled) stream_output_pair(output, pairs[i][0], pairs[i][1]); \
+            } \
+        } \
+        return new_num; \
+    }
+#define STREAM_DEFINE_PROCESS_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(STREAM_DEFINE_PROCESS, name, link, compress)
+
+UF_ENGINE_LIST(STREAM_DEFINE_PROCESS_LAYOUTS)
+UF_BYTE_WEIGHT_ENGINE_LIST(STREAM_DEFINE_PROCESS)
+
+#define STREAM_ENGINE_ENTRY(name, link, compress, layout) {#name, (link), (layout), stream_process_##name},
+#define STREAM_ENGINE_ENTRY_LAYOUTS(name, link, compress) UF_LAYOUT_LIST(STREAM_ENGINE_ENTRY, name, link, compress)
+
+static const struct stream_engine g_stream_engines[] = {
+    UF_ENGINE_LIST(STREAM_ENGINE_ENTRY_LAYOUTS)
+    UF_BYTE_WEIGHT_ENGINE_LIST(STREAM_ENGINE_ENTRY)
+};
+
+static const struct stream_engine *stream_find_engine(const char *name) {
+    for (size_t i = 0; i < sizeof(g_stream_engines) / sizeof(g_stream_engines[0]); i++) {
+        if (strcmp(g_stream_engines[i].name, name) == 0) return &g_stream_engines[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 解析和处理的状态。
+ *
+ * 输入对可能跨越两次read的边界，由parser保存已读到的前一个对象。
+ */
+struct stream_state {
+    const struct stream_engine *engine;
+    struct uf_storage *storage;
+    struct stream_output output;
+    struct pair_text_parser parser;
+    long long pair_num, new_num;
+};
+
+static void stream_flush_pairs(struct stream_state *state) {
+    struct pair_text_parser *parser = &state->parser;
+    state->new_num += state->engine->process(state->storage, parser->pairs, parser->pair_len, &state->output);
+    state->pair_num += parser->pair_len;
+    parser->pair_len = 0;
+    return;
+}
+
+static void stream_fail(struct stream_state *state, const char *message) {
+    fprintf(stderr, "connectivity-stream: %s at byte %lld.\n", message, state->parser.offset);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief 解析[begin, end)中的全部整数，每解析STREAM_BATCH_PAIRS个输入对交给引擎处理一次。
+ *
+ * 调用者保证区间末尾不会截断一个整数。
+ */
+static void stream_parse(struct stream_state *state, const char *begin, const char *end) {
+    enum pair_text_status status;
+    while ((status = pair_text_parse(&state->parser, begin, end, &begin)) == PAIR_TEXT_FULL) stream_flush_pairs(state);
+    if (status != PAIR_TEXT_OK) stream_fail(state, pair_text_error(status));
+    return;
+}
+
+/**
+ * @brief 将普通文件整个映射到内存中解析，文件不能映射时返回false。
+ */
+static bool stream_parse_mapped(struct stream_state *state, int fd) {
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) return false;
+
+    char *base = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) return false;
+    madvise(base, file_stat.st_size, MADV_SEQUENTIAL);
+    stream_parse(state, base, base + file_stat.st_size);
+    munmap(base, file_stat.st_size);
+    return true;
+}
+
+/**
+ * @brief 按大块读入并解析，每块末尾不完整的整数留到下一块开头。
+ */
+static void stream_parse_read(struct stream_state *state, int fd) {
+    char *buffer = malloc(STREAM_READ_SIZE);
+    if (buffer == NULL) {
+        fprintf(stderr, "connectivity-stream: not enough memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t carry = 0;
+    for (;;) {
+        ssize_t length = read(fd, buffer + carry, STREAM_READ_SIZE - carry);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            perror("connectivity-stream: read");
+            exit(EXIT_FAILURE);
+        }
+        if (length == 0) break;
+
+        size_t filled = carry + length;
+        size_t complete = filled;
+        while (complete > 0 && !pair_text_is_space(buffer[complete - 1])) complete--;
+        if (complete == 0 && filled == STREAM_READ_SIZE) stream_fail(state, "token too long");
+        stream_parse(state, buffer, buffer + complete);
+        carry = filled - complete;
+        memmove(buffer, buffer + complete, carry);
+    }
+    stream_parse(state, buffer, buffer + carry);
+    free(buffer);
+    return;
+}
+
+/**
+ * @brief 检查二进制输入对文件能否交给引擎，并确定对象个数。
+ */
+static void stream_check_pair_file(struct pair_file *file, long long *object_num) {
+    if (file->index_width != 4) {
+        fprintf(stderr, "connectivity-stream: only pair files with 4-byte indexes are supported.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (*object_num == 0) {
+        if (file->object_num < 1 || file->object_num > INT_MAX) {
+            fprintf(stderr, "object_num out of range.\n");
+            exit(EXIT_FAILURE);
+        }
+        *object_num = file->object_num;
+    }
+    struct pair_file checked = *file;
+    checked.object_num = *object_num;
+    if (!pair_file_validate(&checked)) {
+        fprintf(stderr, "connectivity-stream: object out of range in pair file.\n");
+        exit(EXIT_FAILURE);
+    }
+    return;
+}
+
+static void stream_usage(const char *program) {
+    fprintf(stderr,
+            "syntax: %s -n object_num [-e engine] [-q] [file]\n"
+            "       %s -l\n"
+            "  -n object_num  objects are integers in [0, object_num), optional for binary pair files\n"
+            "  -e engine      union-find engine, default w_qunion_pc_h (see -l)\n"
+            "  -q             do not print new connections, only report statistics\n"
+            "  -l             list available engines\n"
+            "  file           input file, default standard input\n",
+            program, program);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+    const char *engine_name = "w_qunion_pc_h";
+    long long object_num = 0;
+    bool quiet = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:e:qlh")) != -1) {
+        switch (option) {
+        case 'n': {
+            char *str_end = NULL;
+            errno = 0;
+            object_num = strtoll(optarg, &str_end, 0);
+            if (errno == ERANGE || str_end[0] != '\0' || object_num < 1 || object_num > INT_MAX) {
+                fprintf(stderr, "object_num out of range.\n");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        case 'e':
+            engine_name = optarg;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'l':
+            for (size_t i = 0; i < sizeof(g_stream_engines) / sizeof(g_stream_engines[0]); i++) {
+                printf("%s\n", g_stream_engines[i].name);
+            }
+            return 0;
+        default:
+            stream_usage(argv[0]);
+        }
+    }
+    if (argc - optind > 1) stream_usage(argv[0]);
+
+    struct stream_state state = {0};
+    state.engine = stream_find_engine(engine_name);
+    if (state.engine == NULL) {
+        fprintf(stderr, "unknown engine %s, use -l to list available engines.\n", engine_name);
+        exit(EXIT_FAILURE);
+    }
+
+    int fd = STDIN_FILENO;
+    struct pair_file *pair_file = NULL;
+    if (optind < argc && strcmp(argv[optind], "-") != 0) {
+        fd = open(argv[optind], O_RDONLY);
+        if (fd < 0) {
+            perror(argv[optind]);
+            exit(EXIT_FAILURE);
+        }
+        pair_file = pair_file_open(argv[optind]);
+        if (pair_file != NULL) stream_check_pair_file(pair_file, &object_num);
+    }
+    if (object_num == 0) stream_usage(argv[0]);
+
+    int (*pairs)[2] = malloc(sizeof(*pairs) * STREAM_BATCH_PAIRS);
+    pair_text_init(&state.parser, object_num, pairs, STREAM_BATCH_PAIRS);
+    state.storage = uf_new_storage(object_num, state.engine->link, state.engine->layout);
+    state.output.buffer = malloc(STREAM_OUTPUT_SIZE);
+    state.output.enabled = !quiet;
+    if (state.storage == NULL || pairs == NULL || state.output.buffer == NULL) {
+        fprintf(stderr, "not enough memory for %lld objects.\n", object_num);
+        exit(EXIT_FAILURE);
+    }
+
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    if (pair_file != NULL) {
+        // 二进制输入对直接交给引擎
+        state.new_num = state.engine->process(state.storage, pair_file->pairs, pair_file->pair_num, &state.output);
+        state.pair_num = pair_file->pair_num;
+    } else if (!stream_parse_mapped(&state, fd)) {
+        stream_parse_read(&state, fd);
+    }
+    if (state.parser.pending >= 0) {
+        fprintf(stderr, "connectivity-stream: odd number of objects in input, last object ignored.\n");
+    }
+    stream_flush_pairs(&state);
+    stream_output_flush(&state.output);
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double elapsed = (double)(end_time.tv_sec - start_time.tv_sec) + (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+    fprintf(stderr, "%s processed %lld(%.1e) pairs with %lld new connections in %f seconds, %.2e pairs per second.\n",
+            state.engine->name, state.pair_num, (double)state.pair_num, state.new_num, elapsed,
+            elapsed > 0 ? state.pair_num / elapsed : 0.0);
+
+    pair_file_close(pair_file);
+    if (fd != STDIN_FILENO) close(fd);
+    free(state.output.buffer);
+    free(pairs);
+    uf_delete_storage(state.storage);
+    return 0;
+}
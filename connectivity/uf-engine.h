@@ -0,0 +1,370 @@
+#ifndef HEADER_UF_ENGINE_H
+#define HEADER_UF_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "connectivity-stats.h"
+
+/****************************************
+ * @ingroup UnionFindEngine
+ *
+ * 通用Union-find引擎的头文件。
+ *
+ * 连接策略、路径压缩策略与节点排列方式都以编译期常量的形式传给本文件中的always_inline函数，
+ * 编译器内联后会把策略分支全部折叠掉，
+ * 因此每一种策略组合最终都会成为一段独立的、没有函数调用和策略分支的热循环。
+ ****************************************/
+
+/**
+ * @brief 联合操作中选择新根节点的策略。
+ */
+enum uf_link_policy {
+    UF_LINK_NONE,   ///< 固定将前一个树连接到后一个树下(Quick-union)
+    UF_LINK_SIZE,   ///< 将节点数较少的树连接到节点数较多的树下(Weighted-quick-union)
+    UF_LINK_HEIGHT, ///< 将高度较小的树连接到高度较大的树下(Heighted-quick-union)
+    UF_LINK_RANK    ///< 按秩连接，与UF_LINK_HEIGHT规则相同，但在路径压缩下秩只是树高的上界
+};
+
+/**
+ * @brief 搜索操作中压缩路径的策略。
+ */
+enum uf_compress_policy {
+    UF_COMPRESS_NONE,     ///< 不压缩
+    UF_COMPRESS_FULL,     ///< 完全路径压缩: 将路径上的所有节点直接连接到根节点
+    UF_COMPRESS_HALVING,  ///< 减半路径压缩: 每隔一个节点连接到其祖父节点
+    UF_COMPRESS_SPLITTING ///< 分裂路径压缩: 路径上的每个节点都连接到其祖父节点
+};
+
+/**
+ * @brief 节点数据在内存中的排列方式。
+ */
+enum uf_layout {
+    UF_LAYOUT_SPLIT,        ///< 父节点和权重分别存放在两个数组中
+    UF_LAYOUT_INTERLEAVED,  ///< 父节点和权重交错存放在同一个结构体数组中
+    UF_LAYOUT_ROOT_ENCODED, ///< 根节点在自己的data元素中以负数存放权重，不分配权重数组
+    UF_LAYOUT_BYTE_WEIGHT,  ///< 权重存放在uint8_t数组中，只适用于按高度或按秩连接
+    UF_LAYOUT_ZERO_INIT     ///< 全0的元素表示只有单个节点的树，存储可直接由calloc分配
+};
+
+/**
+ * @brief 交错排列时的节点结构，一个节点正好占用8个字节。
+ */
+struct uf_node {
+    int parent, weight;
+};
+
+/**
+ * @brief 通用引擎的存储结构。
+ *
+ * 分开排列时，data与Quick-union算法的存储数组含义相同，
+ * weight只在根节点上有意义，按连接策略分别存储树的节点数、高度或秩，
+ * 连接策略为UF_LINK_NONE时不分配weight。
+ *
+ * 交错排列时，只分配nodes，data和weight都为NULL。
+ * 联合操作需要同时读写根节点的父节点和权重，
+ * 交错排列使两者落在同一条cache line上，每个根节点只需访问一次内存。
+ *
+ * 根节点编码排列时，只分配data。
+ * 子节点的data仍是父节点的序号(非负数)，根节点的data则是负数，
+ * 按节点数连接时为节点数的相反数，按高度或按秩连接时为-1-高度(秩)。
+ *
+ * 字节权重排列时，data与分开排列相同，权重存放在byte_weight中。
+ * 按秩连接时秩不会超过lgN，因此一个字节就足以存放。
+ *
+ * 零初始化排列时，只分配data，且data的初值全为0。
+ * 子节点的data是父节点的序号加1(正数)，
+ * 根节点的data是初始权重减去当前权重(0或负数)，
+ * 因此全0的元素恰好表示权重为初始值的根节点。
+ */
+struct uf_storage {
+    int *data, *weight;
+    struct uf_node *nodes;
+    uint8_t *byte_weight;
+    size_t object_num;
+    enum uf_link_policy link;
+    enum uf_layout layout;
+};
+
+struct uf_storage *uf_new_storage(size_t object_num, enum uf_link_policy link, enum uf_layout layout);
+bool uf_grow_storage(struct uf_storage *storage, size_t object_num);
+void uf_delete_storage(struct uf_storage *storage);
+
+#define UF_ALWAYS_INLINE static inline __attribute__((always_inline))
+
+/**
+ * @brief 单个节点(只包含单个节点的树)的权重: 节点数为1，高度和秩为0。
+ */
+UF_ALWAYS_INLINE int uf_initial_weight(enum uf_link_policy link) {
+    return link == UF_LINK_SIZE ? 1 : 0;
+}
+
+/**
+ * @brief 读取i的父节点。
+ *
+ * 根节点编码排列和零初始化排列下，根节点读到的是负数。
+ */
+UF_ALWAYS_INLINE int uf_parent(struct uf_storage *storage, int i, enum uf_layout layout) {
+    switch (layout) {
+    case UF_LAYOUT_INTERLEAVED:
+        return storage->nodes[i].parent;
+    case UF_LAYOUT_ZERO_INIT:
+        return storage->data[i] - 1;
+    default:
+        return storage->data[i];
+    }
+}
+
+UF_ALWAYS_INLINE void uf_set_parent(struct uf_storage *storage, int i, int parent, enum uf_layout layout) {
+    switch (layout) {
+    case UF_LAYOUT_INTERLEAVED:
+        storage->nodes[i].parent = parent;
+        return;
+    case UF_LAYOUT_ZERO_INIT:
+        storage->data[i] = parent + 1;
+        return;
+    default:
+        storage->data[i] = parent;
+        return;
+    }
+}
+
+/**
+ * @brief 判断读到parent的节点i是否为根节点。
+ */
+UF_ALWAYS_INLINE bool uf_is_root(int i, int parent, enum uf_layout layout) {
+    return layout == UF_LAYOUT_ROOT_ENCODED || layout == UF_LAYOUT_ZERO_INIT ? parent < 0 : parent == i;
+}
+
+UF_ALWAYS_INLINE int uf_weight(struct uf_storage *storage, int root, enum uf_link_policy link, enum uf_layout layout) {
+    switch (layout) {
+    case UF_LAYOUT_SPLIT:
+        return storage->weight[root];
+    case UF_LAYOUT_INTERLEAVED:
+        return storage->nodes[root].weight;
+    case UF_LAYOUT_ROOT_ENCODED:
+        return uf_initial_weight(link) - 1 - storage->data[root];
+    case UF_LAYOUT_BYTE_WEIGHT:
+        return storage->byte_weight[root];
+    case UF_LAYOUT_ZERO_INIT:
+        return uf_initial_weight(link) - storage->data[root];
+    }
+    return 0;
+}
+
+UF_ALWAYS_INLINE void uf_set_weight(struct uf_storage *storage, int root, int weight, enum uf_link_policy link, enum uf_layout layout) {
+    switch (layout) {
+    case UF_LAYOUT_SPLIT:
+        storage->weight[root] = weight;
+        return;
+    case UF_LAYOUT_INTERLEAVED:
+        storage->nodes[root].weight = weight;
+        return;
+    case UF_LAYOUT_ROOT_ENCODED:
+        storage->data[root] = uf_initial_weight(link) - 1 - weight;
+        return;
+    case UF_LAYOUT_BYTE_WEIGHT:
+        storage->byte_weight[root] = weight;
+        return;
+    case UF_LAYOUT_ZERO_INIT:
+        storage->data[root] = uf_initial_weight(link) - weight;
+        return;
+    }
+    return;
+}
+
+/**
+ * @brief 追溯p的根节点，并按compress策略压缩追溯经过的路径。
+ */
+UF_ALWAYS_INLINE int uf_find(struct uf_storage *storage, int p, enum uf_compress_policy compress, enum uf_layout layout) {
+    int i, root, parent, grandparent;
+    CONNECTIVITY_STATS_FIND_BEGIN();
+
+    switch (compress) {
+    case UF_COMPRESS_NONE:
+        for (i = p; !uf_is_root(i, parent = uf_parent(storage, i, layout), layout); i = parent) CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_FIND_END();
+        return i;
+    case UF_COMPRESS_FULL:
+        for (root = p; !uf_is_root(root, parent = uf_parent(storage, root, layout), layout); root = parent) CONNECTIVITY_STATS_HOP();
+        CONNECTIVITY_STATS_FIND_END();
+        for (i = p; i != root; i = parent) {
+            parent = uf_parent(storage, i, layout);
+            uf_set_parent(storage, i, root, layout);
+            CONNECTIVITY_STATS_COMPRESSION_WRITE();
+        }
+        return root;
+    case UF_COMPRESS_HALVING:
+        for (i = p; !uf_is_root(i, parent = uf_parent(storage, i, layout), layout); i = grandparent) {
+            CONNECTIVITY_STATS_HOP();
+            grandparent = uf_parent(storage, parent, layout);
+            if (uf_is_root(parent, grandparent, layout)) {
+                CONNECTIVITY_STATS_FIND_END();
+                return parent;
+            }
+            uf_set_parent(storage, i, grandparent, layout);
+            CONNECTIVITY_STATS_COMPRESSION_WRITE();
+        }
+        CONNECTIVITY_STATS_FIND_END();
+        return i;
+    case UF_COMPRESS_SPLITTING:
+        for (i = p; !uf_is_root(i, parent = uf_parent(storage, i, layout), layout); i = parent) {
+            CONNECTIVITY_STATS_HOP();
+            grandparent = uf_parent(storage, parent, layout);
+            if (uf_is_root(parent, grandparent, layout)) {
+                CONNECTIVITY_STATS_FIND_END();
+                return parent;
+            }
+            uf_set_parent(storage, i, grandparent, layout);
+            CONNECTIVITY_STATS_COMPRESSION_WRITE();
+        }
+        CONNECTIVITY_STATS_FIND_END();
+        return i;
+    }
+    return p;
+}
+
+/**
+ * @brief 按link策略将两个不同的根节点联合到一起。
+ *
+ * 根节点编码排列下，设置父节点会覆盖被连接的根节点原有的权重，
+ * 因此必须先读出两个根节点的权重。
+ */
+UF_ALWAYS_INLINE void uf_link(struct uf_storage *storage, int proot, int qroot, enum uf_link_policy link, enum uf_layout layout) {
+    int pweight, qweight;
+
+    if (link == UF_LINK_NONE) {
+        CONNECTIVITY_STATS_UNION(0);
+        uf_set_parent(storage, proot, qroot, layout);
+        return;
+    }
+
+    pweight = uf_weight(storage, proot, link, layout);
+    qweight = uf_weight(storage, qroot, link, layout);
+    // 按高度或秩连接时权重不是节点数
+    CONNECTIVITY_STATS_UNION(link == UF_LINK_SIZE ? (pweight < qweight ? pweight : qweight) : 0);
+
+    switch (link) {
+    case UF_LINK_NONE:
+        return;
+    case UF_LINK_SIZE:
+        if (pweight < qweight) {
+            uf_set_parent(storage, proot, qroot, layout);
+            uf_set_weight(storage, qroot, qweight + pweight, link, layout);
+        } else {
+            uf_set_parent(storage, qroot, proot, layout);
+            uf_set_weight(storage, proot, pweight + qweight, link, layout);
+        }
+        return;
+    case UF_LINK_HEIGHT:
+    case UF_LINK_RANK:
+        if (pweight < qweight) {
+            uf_set_parent(storage, proot, qroot, layout);
+        } else if (pweight > qweight) {
+            uf_set_parent(storage, qroot, proot, layout);
+        } else {
+            uf_set_parent(storage, qroot, proot, layout);
+            uf_set_weight(storage, proot, pweight + 1, link, layout);
+        }
+        return;
+    }
+    return;
+}
+
+UF_ALWAYS_INLINE bool uf_is_new_connection(struct uf_storage *storage, int p, int q,
+                                           enum uf_link_policy link, enum uf_compress_policy compress,
+                                           enum uf_layout layout) {
+    int proot = uf_find(storage, p, compress, layout);
+    int qroot = uf_find(storage, q, compress, layout);
+    if (proot == qroot) return false;
+    uf_link(storage, proot, qroot, link, layout);
+    return true;
+}
+
+/**
+ * @brief 引擎的全部策略组合。
+ *
+ * 每一项为(名称, 连接策略, 压缩策略)，
+ * 名称沿用各算法文件的前缀: qunion/w_qunion/h_qunion，r_qunion表示按秩连接，
+ * 后缀_pc/_pc_h/_pc_s分别表示完全/减半/分裂路径压缩。
+ */
+#define UF_ENGINE_LIST(X) \
+    X(qunion,        UF_LINK_NONE,   UF_COMPRESS_NONE) \
+    X(qunion_pc,     UF_LINK_NONE,   UF_COMPRESS_FULL) \
+    X(qunion_pc_h,   UF_LINK_NONE,   UF_COMPRESS_HALVING) \
+    X(qunion_pc_s,   UF_LINK_NONE,   UF_COMPRESS_SPLITTING) \
+    X(w_qunion,      UF_LINK_SIZE,   UF_COMPRESS_NONE) \
+    X(w_qunion_pc,   UF_LINK_SIZE,   UF_COMPRESS_FULL) \
+    X(w_qunion_pc_h, UF_LINK_SIZE,   UF_COMPRESS_HALVING) \
+    X(w_qunion_pc_s, UF_LINK_SIZE,   UF_COMPRESS_SPLITTING) \
+    X(h_qunion,      UF_LINK_HEIGHT, UF_COMPRESS_NONE) \
+    X(h_qunion_pc,   UF_LINK_HEIGHT, UF_COMPRESS_FULL) \
+    X(h_qunion_pc_h, UF_LINK_HEIGHT, UF_COMPRESS_HALVING) \
+    X(h_qunion_pc_s, UF_LINK_HEIGHT, UF_COMPRESS_SPLITTING) \
+    X(r_qunion,      UF_LINK_RANK,   UF_COMPRESS_NONE) \
+    X(r_qunion_pc,   UF_LINK_RANK,   UF_COMPRESS_FULL) \
+    X(r_qunion_pc_h, UF_LINK_RANK,   UF_COMPRESS_HALVING) \
+    X(r_qunion_pc_s, UF_LINK_RANK,   UF_COMPRESS_SPLITTING)
+
+/**
+ * @brief 对一种策略组合列出全部排列方式。
+ *
+ * 每一项为(名称, 连接策略, 压缩策略, 排列方式)，
+ * 分开排列沿用原名称，交错排列在名称后加_il，根节点编码排列在名称后加_neg，
+ * 零初始化排列在名称后加_z。
+ * 字节权重排列只适用于部分连接策略，见UF_BYTE_WEIGHT_ENGINE_LIST。
+ */
+#define UF_LAYOUT_LIST(X, name, link, compress) \
+    X(name,       link, compress, UF_LAYOUT_SPLIT) \
+    X(name##_il,  link, compress, UF_LAYOUT_INTERLEAVED) \
+    X(name##_neg, link, compress, UF_LAYOUT_ROOT_ENCODED) \
+    X(name##_z,   link, compress, UF_LAYOUT_ZERO_INIT)
+
+/**
+ * @brief 使用字节权重排列的策略组合，名称后加_u8。
+ *
+ * 每一项为(名称, 连接策略, 压缩策略, 排列方式)。
+ */
+#define UF_BYTE_WEIGHT_ENGINE_LIST(X) \
+    X(h_qunion_u8,      UF_LINK_HEIGHT, UF_COMPRESS_NONE,      UF_LAYOUT_BYTE_WEIGHT) \
+    X(h_qunion_pc_u8,   UF_LINK_HEIGHT, UF_COMPRESS_FULL,      UF_LAYOUT_BYTE_WEIGHT) \
+    X(h_qunion_pc_h_u8, UF_LINK_HEIGHT, UF_COMPRESS_HALVING,   UF_LAYOUT_BYTE_WEIGHT) \
+    X(h_qunion_pc_s_u8, UF_LINK_HEIGHT, UF_COMPRESS_SPLITTING, UF_LAYOUT_BYTE_WEIGHT) \
+    X(r_qunion_u8,      UF_LINK_RANK,   UF_COMPRESS_NONE,      UF_LAYOUT_BYTE_WEIGHT) \
+    X(r_qunion_pc_u8,   UF_LINK_RANK,   UF_COMPRESS_FULL,      UF_LAYOUT_BYTE_WEIGHT) \
+    X(r_qunion_pc_h_u8, UF_LINK_RANK,   UF_COMPRESS_HALVING,   UF_LAYOUT_BYTE_WEIGHT) \
+    X(r_qunion_pc_s_u8, UF_LINK_RANK,   UF_COMPRESS_SPLITTING, UF_LAYOUT_BYTE_WEIGHT)
+
+/**
+ * @brief 为一种策略组合和排列方式生成uf_<name>_new_storage、uf_<name>_is_new_connection
+ * 以及查询操作uf_<name>_find、uf_<name>_connected。
+ *
+ * find和connected按compress策略压缩路径，
+ * *_readonly版本不压缩路径，只读取存储结构，可以由多个线程同时调用。
+ */
+#define UF_DEFINE_ENGINE_LAYOUT(name, link, compress, layout) \
+    static inline struct uf_storage *uf_##name##_new_storage(size_t object_num) { \
+        return uf_new_storage(object_num, (link), (layout)); \
+    } \
+    static inline bool uf_##name##_is_new_connection(struct uf_storage *storage, int p, int q) { \
+        return uf_is_new_connection(storage, p, q, (link), (compress), (layout)); \
+    } \
+    static inline int uf_##name##_find(struct uf_storage *storage, int p) { \
+        return uf_find(storage, p, (compress), (layout)); \
+    } \
+    static inline bool uf_##name##_connected(struct uf_storage *storage, int p, int q) { \
+        return uf_find(storage, p, (compress), (layout)) == uf_find(storage, q, (compress), (layout)); \
+    } \
+    static inline int uf_##name##_find_readonly(const struct uf_storage *storage, int p) { \
+        return uf_find((struct uf_storage *)storage, p, UF_COMPRESS_NONE, (layout)); \
+    } \
+    static inline bool uf_##name##_connected_readonly(const struct uf_storage *storage, int p, int q) { \
+        return uf_##name##_find_readonly(storage, p) == uf_##name##_find_readonly(storage, q); \
+    }
+
+#define UF_DEFINE_ENGINE(name, link, compress) UF_LAYOUT_LIST(UF_DEFINE_ENGINE_LAYOUT, name, link, compress)
+
+UF_ENGINE_LIST(UF_DEFINE_ENGINE)
+UF_BYTE_WEIGHT_ENGINE_LIST(UF_DEFINE_ENGINE_LAYOUT)
+
+#endif // HEADER_UF_ENGINE_H